@@ -0,0 +1,319 @@
+//
+//  TestPerformance.m
+//  TotalObserverTests
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+@import XCTest;
+#import <TotalObserver/TotalObserver.h>
+#import <objc/runtime.h>
+#import <stdatomic.h>
+#import "ModelObject.h"
+
+// private class, declared here to exercise it directly
+@interface TOObservationRegistry : NSObject
++ (void)addObservation:(id)observation toObject:(id)associationTarget indexKey:(nullable NSString *)indexKey;
++ (void)removeObservation:(id)observation fromObject:(id)associationTarget indexKey:(nullable NSString *)indexKey;
+@end
+
+@interface TOObservation (PrivateMethodExposedForTesting)
++ (NSSet *)associatedObservationsForObservee:(id)object;
+@end
+
+@interface TOKVOObservation (PrivateMethodsExposedForTesting)
+- (instancetype)initWithObject:(id)object keyPaths:(NSArray *)keyPaths options:(int)options queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue block:(TOAnonymousObservationBlock)block;
+- (void)takeChange:(nullable NSDictionary *)change forKeyPath:(nullable NSString *)keyPath;
+@end
+
+static const NSUInteger TestContentionThreadCount = 16;
+static const NSUInteger TestContentionTargetCount = 64;
+static const NSUInteger TestContentionOperationsPerThread = 5000;
+
+static const NSUInteger TestScreenObservationCount = 50;
+static const NSUInteger TestScreenRepetitions = 500;
+
+static const NSUInteger TestKVOEventCount = 1000000;
+static const void *volatile TestKVOEventSink; // keeps the value read from being optimized away
+
+static const NSUInteger TestFanoutObservationCount = 10000;
+static const NSUInteger TestFanoutPosts = 10;
+static const NSUInteger TestFanoutWorkPerDelivery = 2000;
+static _Atomic(NSUInteger) TestFanoutDeliveriesRemaining;
+
+// stands in for what an observation block would do with each delivery
+static NSUInteger TestFanoutWork(NSUInteger seed)
+{
+    volatile NSUInteger value = seed;
+    for (NSUInteger i = 0; i < TestFanoutWorkPerDelivery; ++i) {
+        value = value * 1103515245 + 12345;
+    }
+    return value;
+}
+
+// the way observations were stored before TOObservationRegistry, kept here to compare against
+static const int TestLegacySetKeyVar;
+static void *TestLegacySetKey = (void *)&TestLegacySetKeyVar;
+
+static void TestLegacyStore(id observation, id associationTarget)
+{
+    NSMutableSet *observationSet = nil;
+    @synchronized(associationTarget) {
+        observationSet = objc_getAssociatedObject(associationTarget, TestLegacySetKey);
+        if (observationSet == nil) {
+            observationSet = [NSMutableSet set];
+            objc_setAssociatedObject(associationTarget, TestLegacySetKey, observationSet, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        }
+    }
+    @synchronized(observationSet) {
+        [observationSet addObject:observation];
+    }
+}
+
+static void TestLegacyRemove(id observation, id associationTarget)
+{
+    NSMutableSet *observationSet = nil;
+    @synchronized(associationTarget) {
+        observationSet = objc_getAssociatedObject(associationTarget, TestLegacySetKey);
+    }
+    if (observationSet != nil) {
+        @synchronized(observationSet) {
+            [observationSet removeObject:observation];
+        }
+    }
+}
+
+// the way KVO events were taken before their properties were decoded lazily, kept here to compare against
+@interface TestEagerKVOEvent : NSObject
+@property (nonatomic, copy) NSString *keyPath;
+@property (nonatomic) NSDictionary *changeDict;
+@property (nonatomic) NSUInteger kind;
+@property (nonatomic) BOOL prior;
+@property (nonatomic, nullable) id changedValue;
+@property (nonatomic, nullable) id oldValue;
+@property (nonatomic, nullable) NSIndexSet *indexes;
+@end
+
+@implementation TestEagerKVOEvent
+
+- (void)takeChange:(nullable NSDictionary *)change forKeyPath:(nullable NSString *)keyPath
+{
+    self.keyPath = keyPath;
+    self.changeDict = change;
+    self.kind = [(NSNumber *)change[NSKeyValueChangeKindKey] unsignedIntegerValue];
+    self.prior = [(NSNumber *)change[NSKeyValueChangeNotificationIsPriorKey] unsignedIntegerValue];
+    self.changedValue = change[NSKeyValueChangeNewKey];
+    self.oldValue = change[NSKeyValueChangeOldKey];
+    self.indexes = change[NSKeyValueChangeIndexesKey];
+}
+
+@end
+
+
+@interface TestPerformance : XCTestCase
+@end
+
+@implementation TestPerformance
+
+- (void)runContentionWithStore:(void(^)(id observation, id target))store remove:(void(^)(id observation, id target))remove
+{
+    NSMutableArray *targets = [NSMutableArray array];
+    for (NSUInteger i = 0; i < TestContentionTargetCount; ++i) {
+        [targets addObject:[[NSObject alloc] init]];
+    }
+
+    // explicit threads rather than dispatch_apply, which wouldn't go wider than the number of cores
+    dispatch_group_t group = dispatch_group_create();
+    for (NSUInteger t = 0; t < TestContentionThreadCount; ++t) {
+        dispatch_group_enter(group);
+        NSThread *thread = [[NSThread alloc] initWithTarget:[NSBlockOperation blockOperationWithBlock:^{
+            NSMutableArray *observations = [NSMutableArray arrayWithCapacity:8];
+            for (NSUInteger i = 0; i < TestContentionOperationsPerThread; ++i) {
+                id target = targets[(t * 7 + i / 8) % TestContentionTargetCount]; // threads overlap on targets
+                id observation = [[NSObject alloc] init];
+                store(observation, target);
+                [observations addObject:observation];
+                if (observations.count == 8) {
+                    for (id o in observations) {
+                        remove(o, target);
+                    }
+                    [observations removeAllObjects];
+                }
+            }
+            dispatch_group_leave(group);
+        }] selector:@selector(start) object:nil];
+        [thread start];
+    }
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+}
+
+- (void)testContentionSynchronizedBaseline
+{
+    [self measureBlock:^{
+        [self runContentionWithStore:^(id observation, id target) {
+            TestLegacyStore(observation, target);
+        } remove:^(id observation, id target) {
+            TestLegacyRemove(observation, target);
+        }];
+    }];
+}
+
+- (void)testContentionStripedLocks
+{
+    [self measureBlock:^{
+        [self runContentionWithStore:^(id observation, id target) {
+            [TOObservationRegistry addObservation:observation toObject:target indexKey:nil];
+        } remove:^(id observation, id target) {
+            [TOObservationRegistry removeObservation:observation fromObject:target indexKey:nil];
+        }];
+    }];
+}
+
+- (void)testDeallocOfUnobservedInstancesOfSwizzledClass
+{
+    // make sure ModelObject's dealloc is swizzled, then only ever observe this one instance
+    ModelObject *observedObject = [[ModelObject alloc] init];
+    [observedObject to_observeNotificationsNamed:NameChangedNotification withBlock:^(TOObservation *obs) { }];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100000; ++i) {
+            @autoreleasepool {
+                ModelObject *object = [[ModelObject alloc] init];
+                object.flag = YES;
+            }
+        }
+    }];
+    XCTAssertEqual([TOObservation associatedObservationsForObservee:observedObject].count, (NSUInteger)1);
+}
+
+
+- (NSArray *)screenNotificationNames
+{
+    NSMutableArray *names = [NSMutableArray array];
+    for (NSUInteger i = 0; i < TestScreenObservationCount; ++i) {
+        [names addObject:[NSString stringWithFormat:@"note%lu", (unsigned long)i]];
+    }
+    return names;
+}
+
+- (void)testSetupAndTeardownIndividually
+{
+    NSArray *names = [self screenNotificationNames];
+    [self measureBlock:^{
+        for (NSUInteger r = 0; r < TestScreenRepetitions; ++r) {
+            @autoreleasepool {
+                ModelObject *object = [[ModelObject alloc] init];
+                NSMutableArray *observations = [NSMutableArray arrayWithCapacity:TestScreenObservationCount];
+                for (NSString *name in names) {
+                    [observations addObject:[self to_observeForNotifications:object named:name withBlock:^(id obj, TOObservation *obs) { }]];
+                }
+                for (TOObservation *observation in observations) {
+                    [observation remove];
+                }
+            }
+        }
+    }];
+}
+
+- (void)testSetupAndTeardownWithBag
+{
+    NSArray *names = [self screenNotificationNames];
+    [self measureBlock:^{
+        for (NSUInteger r = 0; r < TestScreenRepetitions; ++r) {
+            @autoreleasepool {
+                ModelObject *object = [[ModelObject alloc] init];
+                TOObservationBag *bag = [[TOObservationBag alloc] init];
+                [bag addObservationsWithBlock:^{
+                    for (NSString *name in names) {
+                        [self to_observeForNotifications:object named:name withBlock:^(id obj, TOObservation *obs) { }];
+                    }
+                }];
+                [bag removeAll];
+            }
+        }
+    }];
+}
+
+
+- (void)runFanoutWithExecutor:(id<TOExecutor>(^)(void))makeExecutor
+{
+    ModelObject *object = [[ModelObject alloc] init];
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    
+    TOObservationBag *bag = [[TOObservationBag alloc] init];
+    [bag addObservationsWithBlock:^{
+        for (NSUInteger i = 0; i < TestFanoutObservationCount; ++i) {
+            [self to_observeForNotifications:object named:@"fanout" onExecutor:makeExecutor() withBlock:^(id obj, TOObservation *obs) {
+                TestFanoutWork(i);
+                if (atomic_fetch_sub(&TestFanoutDeliveriesRemaining, 1) == 1)
+                    dispatch_semaphore_signal(finished);
+            }];
+        }
+    }];
+    
+    [self measureBlock:^{
+        atomic_store(&TestFanoutDeliveriesRemaining, TestFanoutObservationCount * TestFanoutPosts);
+        for (NSUInteger p = 0; p < TestFanoutPosts; ++p) {
+            [object to_postNotificationNamed:@"fanout"];
+        }
+        dispatch_semaphore_wait(finished, DISPATCH_TIME_FOREVER);
+    }];
+    [bag removeAll];
+}
+
+- (void)testFanoutInline
+{
+    [self runFanoutWithExecutor:^id<TOExecutor>{
+        return nil;
+    }];
+}
+
+- (void)testFanoutToSerialQueue
+{
+    TOGCDQueueExecutor *executor = [[TOGCDQueueExecutor alloc] initWithQueue:dispatch_queue_create("fanout", DISPATCH_QUEUE_SERIAL)];
+    [self runFanoutWithExecutor:^id<TOExecutor>{
+        return executor;
+    }];
+}
+
+- (void)testFanoutToWorkStealingExecutor
+{
+    TOWorkStealingExecutor *executor = [[TOWorkStealingExecutor alloc] init];
+    [self runFanoutWithExecutor:^id<TOExecutor>{
+        return [executor serialExecutor]; // one each, so each observation's deliveries stay in order
+    }];
+}
+
+
+- (NSDictionary *)kvoEventChange
+{
+    return @{ NSKeyValueChangeKindKey: @(NSKeyValueChangeSetting), NSKeyValueChangeNewKey: @"new", NSKeyValueChangeOldKey: @"old" };
+}
+
+// each event taken and then only its changed value read, as most observation blocks do
+- (void)testKVOEventDecodingEagerBaseline
+{
+    NSDictionary *change = [self kvoEventChange];
+    TestEagerKVOEvent *event = [[TestEagerKVOEvent alloc] init];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < TestKVOEventCount; ++i) {
+            [event takeChange:change forKeyPath:@"name"];
+            TestKVOEventSink = (__bridge const void *)event.changedValue;
+        }
+    }];
+}
+
+- (void)testKVOEventDecodingLazy
+{
+    NSDictionary *change = [self kvoEventChange];
+    TOKVOObservation *event = [[TOKVOObservation alloc] initWithObject:[[ModelObject alloc] init] keyPaths:@[@"name"] options:0 queue:nil gcdQueue:nil block:^(TOObservation *obs) { }];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < TestKVOEventCount; ++i) {
+            [event takeChange:change forKeyPath:@"name"];
+            TestKVOEventSink = (__bridge const void *)event.changedValue;
+        }
+    }];
+}
+
+@end
@@ -9,6 +9,23 @@
 @import XCTest;
 #import <TotalObserver/TotalObserver.h>
 #import "ModelObject.h"
+#import <objc/runtime.h>
+#import <pthread.h>
+#import <stdatomic.h>
+
+// libmalloc's hook for allocation logging tools, which isn't in any public header
+typedef void (TestMallocLogger)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numHotFramesToSkip);
+extern TestMallocLogger *malloc_logger;
+#define TestMallocLogTypeAllocate 2
+
+static pthread_t TestCountedAllocationThread;
+static _Atomic(NSUInteger) TestCountedAllocations;
+
+static void TestCountAllocation(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numHotFramesToSkip)
+{
+    if ((type & TestMallocLogTypeAllocate) != 0 && pthread_equal(pthread_self(), TestCountedAllocationThread))
+        atomic_fetch_add(&TestCountedAllocations, 1);
+}
 
 @interface Tests : XCTestCase
 @property (nonatomic, strong) ModelObject *modelObject;
@@ -23,6 +40,10 @@
 + (NSSet *)associatedObservationsForObserver:(nullable id)observer object:(nullable id)object;
 @end
 
+@interface TONotificationObservation (PrivateMethodExposedForTesting)
+- (void)handleNotification:(NSNotification *)notification;
+@end
+
 
 @implementation Tests
 
@@ -41,6 +62,12 @@
     [super tearDown];
 }
 
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+    // for tests that add KVO directly rather than through an observation
+    self.observed = YES;
+}
+
 - (void)testObjectNotification
 {
     typeof(self) __weak welf = self;
@@ -276,6 +303,172 @@
 }
 #endif // disabled because addObserver:forKeyPath:.. seems to crash when run in a text case
 
+- (void)testKVOSharedRegistration
+{
+    NSUInteger __block firstCount = 0;
+    NSUInteger __block secondCount = 0;
+    TOObservation *first = [self.modelObject to_observeChangesToKeyPath:@"flag" withBlock:^(TOObservation *obs) {
+        ++firstCount;
+    }];
+    // asks for an option the first didn't, so the shared registration is replaced, initial value only to this one
+    TOObservation *second = [self.modelObject to_observeChangesToKeyPath:@"flag" options:NSKeyValueObservingOptionNew | NSKeyValueObservingOptionInitial withBlock:^(TOObservation *obs) {
+        ++secondCount;
+    }];
+    XCTAssertEqual(firstCount, (NSUInteger)0);
+    XCTAssertEqual(secondCount, (NSUInteger)1);
+    
+    self.modelObject.flag = YES;
+    XCTAssertEqual(firstCount, (NSUInteger)1);
+    XCTAssertEqual(secondCount, (NSUInteger)2);
+    
+    [first remove];
+    self.modelObject.flag = NO;
+    XCTAssertEqual(firstCount, (NSUInteger)1);
+    XCTAssertEqual(secondCount, (NSUInteger)3);
+    [second remove];
+}
+
+
+- (void)testKVONativeEngine
+{
+    [TOKVOObservation setObservesNatively:YES instancesOfClass:[ModelObject class]];
+    XCTAssertTrue([TOKVOObservation observesNativelyInstancesOfClass:[ModelObject class]]);
+    
+    NSMutableArray *names = [NSMutableArray array];
+    NSMutableArray *flags = [NSMutableArray array];
+    TOObservation *nameObservation = [self.modelObject to_observeChangesToKeyPath:@"name" options:NSKeyValueObservingOptionNew | NSKeyValueObservingOptionOld withBlock:^(TOObservation *obs) {
+        TOKVOObservation *kvoObservation = (TOKVOObservation *)obs;
+        [names addObject:@[kvoObservation.oldValue, kvoObservation.changedValue]];
+    }];
+    TOObservation *flagObservation = [self.modelObject to_observeChangesToKeyPath:@"flag" options:NSKeyValueObservingOptionNew withBlock:^(TOObservation *obs) {
+        TOKVOObservation *kvoObservation = (TOKVOObservation *)obs;
+        XCTAssertNil(kvoObservation.oldValue);
+        XCTAssertEqualObjects(kvoObservation.changeDict[NSKeyValueChangeNewKey], kvoObservation.changedValue);
+        [flags addObject:kvoObservation.changedValue];
+    }];
+    // the generated subclass is hidden, as with KVO
+    XCTAssertNotEqual(object_getClass(self.modelObject), [ModelObject class]);
+    XCTAssertEqualObjects([self.modelObject class], [ModelObject class]);
+    
+    self.modelObject.name = @"first";
+    self.modelObject.name = @"second";
+    self.modelObject.flag = YES;
+    XCTAssertEqualObjects(names, (@[@[[NSNull null], @"first"], @[@"first", @"second"]]));
+    XCTAssertEqualObjects(flags, @[@YES]);
+    
+    // a setter swizzled after the subclass was made is still what the override calls
+    Method setNameMethod = class_getInstanceMethod([ModelObject class], @selector(setName:));
+    IMP originalSetName = method_getImplementation(setNameMethod);
+    NSUInteger __block swizzledCalls = 0;
+    IMP swizzledSetName = imp_implementationWithBlock(^(id object, NSString *name) {
+        ++swizzledCalls;
+        ((void (*)(id, SEL, NSString *))originalSetName)(object, @selector(setName:), name);
+    });
+    method_setImplementation(setNameMethod, swizzledSetName);
+    self.modelObject.name = @"swizzled";
+    method_setImplementation(setNameMethod, originalSetName);
+    imp_removeBlock(swizzledSetName);
+    XCTAssertEqual(swizzledCalls, (NSUInteger)1);
+    XCTAssertEqual(names.count, (NSUInteger)3);
+    
+    [nameObservation remove];
+    XCTAssertNotEqual(object_getClass(self.modelObject), [ModelObject class]); // flag still observed
+    [flagObservation remove];
+    XCTAssertEqual(object_getClass(self.modelObject), [ModelObject class]); // nothing left to override setters for
+    self.modelObject.name = @"third";
+    XCTAssertEqual(names.count, (NSUInteger)3);
+    
+    [TOKVOObservation setObservesNatively:NO instancesOfClass:[ModelObject class]];
+}
+
+- (void)testKVONativeEngineMovesToKVOAddedLater
+{
+    [TOKVOObservation setObservesNatively:YES instancesOfClass:[ModelObject class]];
+    
+    NSMutableArray *names = [NSMutableArray array];
+    TOObservation *observation = [self.modelObject to_observeChangesToKeyPath:@"name" options:NSKeyValueObservingOptionNew withBlock:^(TOObservation *obs) {
+        [names addObject:((TOKVOObservation *)obs).changedValue];
+    }];
+    XCTAssertNotEqual(object_getClass(self.modelObject), [ModelObject class]);
+    
+    // KVO's own subclass would otherwise be of the engine's subclass, and report it from -class
+    [self.modelObject addObserver:self forKeyPath:@"flag" options:0 context:NULL];
+    XCTAssertEqualObjects([self.modelObject class], [ModelObject class]);
+    XCTAssertFalse([NSStringFromClass(object_getClass(self.modelObject)) containsString:@"TONativeObserving_"]);
+    
+    self.modelObject.name = @"after";
+    self.modelObject.flag = YES;
+    XCTAssertEqualObjects(names, @[@"after"]); // the observation moved to KVO along with the object
+    XCTAssertTrue(self.observed);
+    
+    [self.modelObject removeObserver:self forKeyPath:@"flag" context:NULL];
+    [observation remove];
+    XCTAssertEqual(object_getClass(self.modelObject), [ModelObject class]);
+    
+    [TOKVOObservation setObservesNatively:NO instancesOfClass:[ModelObject class]];
+}
+
+
+- (void)testKVOScalarObservationSkipsEqualValues
+{
+    NSMutableArray *changes = [NSMutableArray array];
+    TOObservation *observation = [self.modelObject to_observeBoolChangesToKeyPath:@"flag" withBlock:^(TOKVOObservation *obs, BOOL oldValue, BOOL newValue) {
+        [changes addObject:@[@(oldValue), @(newValue)]];
+    }];
+    XCTAssertNotNil(observation);
+    XCTAssertNil([self.modelObject to_observeBoolChangesToKeyPath:@"name" withBlock:^(TOKVOObservation *obs, BOOL oldValue, BOOL newValue) { }]);
+    
+    self.modelObject.flag = YES;
+    self.modelObject.flag = YES; // unchanged, dropped
+    self.modelObject.flag = NO;
+    XCTAssertEqualObjects(changes, (@[@[@NO, @YES], @[@YES, @NO]]));
+    [observation remove];
+}
+
+
+- (void)testKVOScalarObservationDeliversEventCopies
+{
+    dispatch_queue_t queue = dispatch_queue_create("scalar copies test", DISPATCH_QUEUE_SERIAL);
+    NSMutableArray *changes = [NSMutableArray array];
+    TOObservation *observation = [self.modelObject to_observeBoolChangesToKeyPath:@"flag" onGCDQueue:queue withBlock:^(TOKVOObservation *obs, BOOL oldValue, BOOL newValue) {
+        XCTAssertNotNil(obs.sourceObservation);
+        [changes addObject:@[@(oldValue), @(newValue), obs.changedValue]];
+    }];
+    observation.deliversEventCopies = YES;
+    
+    dispatch_suspend(queue); // so each change is held in its own copy
+    self.modelObject.flag = YES;
+    self.modelObject.flag = NO;
+    dispatch_resume(queue);
+    dispatch_sync(queue, ^{ });
+    XCTAssertEqualObjects(changes, (@[@[@NO, @YES, @YES], @[@YES, @NO, @NO]]));
+    [observation remove];
+}
+
+- (void)testKVODistinctUntilChanged
+{
+    NSMutableArray *keyPaths = [NSMutableArray array];
+    TOObservation *observation = [self.modelObject to_observeChangesToKeyPaths:@[@"name", @"flag"] distinct:TODistinctComparisonEqual withBlock:^(TOObservation *obs) {
+        [keyPaths addObject:((TOKVOObservation *)obs).keyPath];
+    }];
+    
+    self.modelObject.name = @"same";
+    self.modelObject.name = [NSMutableString stringWithString:@"same"]; // equal but not identical, dropped
+    self.modelObject.flag = YES;
+    self.modelObject.flag = YES; // dropped
+    self.modelObject.name = @"different";
+    XCTAssertEqualObjects(keyPaths, (@[@"name", @"flag", @"name"]));
+    
+    // a comparator that considers every value the same
+    ((TOKVOObservation *)observation).distinctComparator = ^BOOL(id oldValue, id newValue) {
+        return YES;
+    };
+    self.modelObject.flag = NO;
+    XCTAssertEqual(keyPaths.count, (NSUInteger)3);
+    [observation remove];
+}
+
+
 - (void)testExplicitRemoval
 {
     TOObservation *observation1 = [self to_observeForNotifications:self.modelObject named:NameChangedNotification withBlock:^(id obj, TOObservation *obs) { }];
@@ -309,6 +502,49 @@
     XCTAssertTrue([observationsAfterRemoval containsObject:observation2]);
 }
 
+- (void)testIndirectRemovalAmongManyObservations
+{
+    NSMutableArray *names = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 500; ++i) {
+        NSString *name = [NSString stringWithFormat:@"note%lu", (unsigned long)i];
+        [names addObject:name];
+        [self to_observeForNotifications:self.modelObject named:name withBlock:^(id obj, TOObservation *obs) { }];
+    }
+    TOObservation *observation = [self to_observeAllNotificationsNamed:names[250] withBlock:^(id obj, TOObservation *obs) { }];
+    XCTAssertEqual([TOObservation associatedObservationsForObserver:self].count, (NSUInteger)501);
+    
+    // same name, but observing any object rather than modelObject, must not be confused with the other
+    BOOL found = [self to_stopObservingForNotifications:self.modelObject named:names[250]];
+    XCTAssertTrue(found);
+    found = [self to_stopObservingForNotifications:self.modelObject named:names[250]];
+    XCTAssertFalse(found);
+    XCTAssertTrue([[TOObservation associatedObservationsForObserver:self] containsObject:observation]);
+    
+    for (NSString *name in names) {
+        [self to_stopObservingForNotifications:self.modelObject named:name];
+    }
+    NSSet *observationsAfterRemoval = [TOObservation associatedObservationsForObserver:self];
+    XCTAssertEqual(observationsAfterRemoval.count, (NSUInteger)1);
+    XCTAssertTrue([observationsAfterRemoval containsObject:observation]);
+}
+
+- (void)testAssociatedObservationsAreSnapshots
+{
+    TOObservation *observation1 = [self to_observeForNotifications:self.modelObject named:NameChangedNotification withBlock:^(id obj, TOObservation *obs) { }];
+    NSSet *snapshot1 = [TOObservation associatedObservationsForObserver:self];
+    XCTAssertEqual(snapshot1, [TOObservation associatedObservationsForObserver:self]); // unchanged, so same snapshot is reused
+    
+    TOObservation *observation2 = [self to_observeAllNotificationsNamed:NameChangedNotification withBlock:^(id obj, TOObservation *obs) { }];
+    NSSet *snapshot2 = [TOObservation associatedObservationsForObserver:self];
+    XCTAssertEqual(snapshot1.count, (NSUInteger)1);
+    XCTAssertTrue([snapshot2 containsObject:observation1]);
+    XCTAssertTrue([snapshot2 containsObject:observation2]);
+    
+    [observation1 remove];
+    XCTAssertTrue([snapshot2 containsObject:observation1]);
+    XCTAssertFalse([[TOObservation associatedObservationsForObserver:self] containsObject:observation1]);
+}
+
 - (void)testImplicitRemoval
 {
     TOObservation *observation1, *observation2;
@@ -331,4 +567,747 @@
     XCTAssertTrue([observationsAfterRemoval containsObject:observation2]);
 }
 
+- (void)testImplicitRemovalWithLifetimeSentinel
+{
+    TOObservation * __block observation1;
+    TOObservation *observation2;
+    @autoreleasepool {
+        [TOObservation performWithAutomaticRemovalMode:TOAutomaticRemovalModeLifetimeSentinel block:^{
+            observation1 = [self to_observeForNotifications:self.modelObject named:NameChangedNotification withBlock:^(id obj, TOObservation *obs) { }];
+        }];
+        observation2 = [self to_observeAllNotificationsNamed:NameChangedNotification withBlock:^(id obj, TOObservation *obs) { }];
+    }
+    XCTAssertEqual(observation1.automaticRemovalMode, TOAutomaticRemovalModeLifetimeSentinel);
+    XCTAssertEqual(observation2.automaticRemovalMode, [TOObservation defaultAutomaticRemovalMode]);
+    XCTAssertTrue(observation1.registered);
+    
+    self.modelObject = nil; // see testImplicitRemoval regarding the @autoreleasepool above
+    
+    XCTAssertFalse(observation1.registered);
+    NSSet *observationsAfterRemoval = [TOObservation associatedObservationsForObserver:self object:nil];
+    XCTAssertFalse([observationsAfterRemoval containsObject:observation1]);
+    XCTAssertTrue([observationsAfterRemoval containsObject:observation2]);
+}
+
+- (void)testImplicitRemovalOfAnonymousObservation
+{
+    TOObservation * __block observation1;
+    TOObservation *observation2;
+    @autoreleasepool {
+        [TOObservation performWithAutomaticRemovalMode:TOAutomaticRemovalModeLifetimeSentinel block:^{
+            observation1 = [self.modelObject to_observeNotificationsNamed:NameChangedNotification withBlock:^(TOObservation *obs) { }];
+        }];
+        observation2 = [self.modelObject to_observeNotificationsNamed:NameChangedNotification withBlock:^(TOObservation *obs) { }];
+    }
+    XCTAssertTrue(observation1.registered);
+    XCTAssertTrue(observation2.registered);
+    
+    self.modelObject = nil; // see testImplicitRemoval regarding the @autoreleasepool above
+    
+    // neither has an observer, and the object's weak property is already nil by the time either is removed
+    XCTAssertFalse(observation1.registered);
+    XCTAssertFalse(observation2.registered);
+}
+
+- (void)testAutomaticRemovalModeRestoredWhenBlockThrows
+{
+    XCTAssertThrows([TOObservation performWithAutomaticRemovalMode:TOAutomaticRemovalModeNone block:^{
+        [NSException raise:NSGenericException format:@"thrown from within the block"];
+    }]);
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:NameChangedNotification withBlock:^(id obj, TOObservation *obs) { }];
+    XCTAssertTrue(observation.removeAutomatically);
+    [observation remove];
+}
+
+- (void)testNoAutomaticRemoval
+{
+    TOObservation * __block observation;
+    @autoreleasepool {
+        [TOObservation performWithAutomaticRemovalMode:TOAutomaticRemovalModeNone block:^{
+            observation = [self to_observeForNotifications:self.modelObject named:NameChangedNotification withBlock:^(id obj, TOObservation *obs) { }];
+        }];
+    }
+    XCTAssertFalse(observation.removeAutomatically);
+    
+    self.modelObject = nil;
+    
+    XCTAssertTrue(observation.registered);
+    XCTAssertTrue([[TOObservation associatedObservationsForObserver:self object:nil] containsObject:observation]);
+    [observation remove];
+}
+
+- (void)testBagStoresObservationsAfterBlock
+{
+    TOObservationBag *bag = [[TOObservationBag alloc] init];
+    TOObservation * __block observation1, * __block observation2;
+    typeof(self) __weak welf = self;
+    [bag addObservationsWithBlock:^{
+        observation1 = [self to_observeForNotifications:self.modelObject named:NameChangedNotification withBlock:^(id obj, TOObservation *obs) {
+            welf.observed = YES;
+        }];
+        observation2 = [self to_observeAllNotificationsNamed:NameChangedNotification withBlock:^(id obj, TOObservation *obs) { }];
+        XCTAssertTrue(observation1.registered);
+        XCTAssertFalse([[TOObservation associatedObservationsForObserver:self] containsObject:observation1]);
+    }];
+    XCTAssertEqualObjects(bag.observations, (@[observation1, observation2]));
+    
+    NSSet *observations = [TOObservation associatedObservationsForObserver:self];
+    XCTAssertTrue([observations containsObject:observation1]);
+    XCTAssertTrue([observations containsObject:observation2]);
+    XCTAssertTrue([[TOObservation associatedObservationsForObservee:self.modelObject] containsObject:observation1]);
+    
+    self.modelObject.name = @""; // should trigger notification, see -[ModelObject setName]
+    XCTAssertTrue(self.observed);
+    
+    BOOL found = [self to_stopObservingForNotifications:self.modelObject named:NameChangedNotification];
+    XCTAssertTrue(found);
+    XCTAssertFalse(observation1.registered);
+}
+
+- (void)testBagStoresObservationsWhenBlockThrows
+{
+    TOObservationBag *bag = [[TOObservationBag alloc] init];
+    TOObservation * __block observation;
+    XCTAssertThrows([bag addObservationsWithBlock:^{
+        observation = [self to_observeForNotifications:self.modelObject named:NameChangedNotification withBlock:^(id obj, TOObservation *obs) { }];
+        [NSException raise:NSGenericException format:@"thrown from within the bag's block"];
+    }]);
+    XCTAssertEqualObjects(bag.observations, @[observation]);
+    XCTAssertTrue([[TOObservation associatedObservationsForObserver:self] containsObject:observation]);
+    
+    // no longer within the bag
+    TOObservation *laterObservation = [self to_observeAllNotificationsNamed:NameChangedNotification withBlock:^(id obj, TOObservation *obs) { }];
+    XCTAssertEqual(bag.observations.count, (NSUInteger)1);
+    XCTAssertTrue([[TOObservation associatedObservationsForObserver:self] containsObject:laterObservation]);
+    [laterObservation remove];
+    [bag removeAll];
+}
+
+- (void)testBagRemoveAll
+{
+    TOObservationBag *bag = [[TOObservationBag alloc] init];
+    [bag addObservationsWithBlock:^{
+        for (NSUInteger i = 0; i < 20; ++i) {
+            [self to_observeForNotifications:self.modelObject named:[NSString stringWithFormat:@"note%lu", (unsigned long)i] withBlock:^(id obj, TOObservation *obs) { }];
+        }
+    }];
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:NameChangedNotification withBlock:^(typeof(self) obj, TOObservation *obs) {
+        obj.observed = YES;
+    }];
+    [bag addObservation:observation];
+    NSArray *observations = bag.observations;
+    XCTAssertEqual(observations.count, (NSUInteger)21);
+    XCTAssertEqual([TOObservation associatedObservationsForObserver:self].count, (NSUInteger)21);
+    
+    [bag removeAll];
+    
+    XCTAssertEqual(bag.observations.count, (NSUInteger)0);
+    XCTAssertEqual([TOObservation associatedObservationsForObserver:self].count, (NSUInteger)0);
+    XCTAssertEqual([TOObservation associatedObservationsForObservee:self.modelObject].count, (NSUInteger)0);
+    for (TOObservation *removedObservation in observations) {
+        XCTAssertFalse(removedObservation.registered);
+    }
+    self.modelObject.name = @"";
+    XCTAssertFalse(self.observed);
+}
+
+- (void)testBagRemoveAllCancelsQueuedDeliveries
+{
+    dispatch_queue_t queue = dispatch_queue_create("bag remove test", DISPATCH_QUEUE_SERIAL);
+    __block NSUInteger deliveries = 0;
+    TOObservationBag *bag = [[TOObservationBag alloc] init];
+    [bag addObservationsWithBlock:^{
+        [self to_observeForNotifications:self.modelObject named:@"queued" onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+            ++deliveries;
+        }];
+        TOObservation *buffered = [self to_observeForNotifications:self.modelObject named:@"queued" onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+            ++deliveries;
+        }];
+        buffered.maximumPendingDeliveries = 10;
+    }];
+    
+    dispatch_suspend(queue);
+    for (NSUInteger i = 0; i < 5; ++i) {
+        [self.modelObject to_postNotificationNamed:@"queued" userInfo:@{@"i": @(i)}];
+    }
+    [bag removeAll];
+    dispatch_resume(queue);
+    dispatch_sync(queue, ^{ });
+    
+    XCTAssertEqual(deliveries, (NSUInteger)0);
+}
+
+- (void)testBagRemovesOnDealloc
+{
+    TOObservation * __block observation;
+    @autoreleasepool {
+        TOObservationBag *bag = [[TOObservationBag alloc] init];
+        [bag addObservationsWithBlock:^{
+            observation = [self to_observeForNotifications:self.modelObject named:NameChangedNotification withBlock:^(id obj, TOObservation *obs) { }];
+        }];
+        XCTAssertTrue(observation.registered);
+        bag = nil;
+    }
+    XCTAssertFalse(observation.registered);
+    XCTAssertFalse([[TOObservation associatedObservationsForObserver:self] containsObject:observation]);
+}
+
+
+- (void)testCoalescedNotifications
+{
+    dispatch_queue_t queue = dispatch_queue_create("coalescing test", DISPATCH_QUEUE_SERIAL);
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Coalesced Notification"];
+    NSUInteger __block deliveries = 0;
+    NSUInteger __block mergedCount = 0;
+    NSString * __block latestName = nil;
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:NameChangedNotification onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+        ++deliveries;
+        mergedCount = obs.coalescedTriggerCount;
+        latestName = ((ModelObject *)((TONotificationObservation *)obs).postedObject).name;
+        [expectation fulfill];
+    }];
+    observation.coalescesDeliveries = YES;
+    
+    dispatch_suspend(queue); // hold deliveries until all triggers have occurred
+    for (NSUInteger i = 0; i < 5; ++i) {
+        self.modelObject.name = [NSString stringWithFormat:@"%lu", (unsigned long)i];
+    }
+    dispatch_resume(queue);
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    dispatch_sync(queue, ^{ });
+    XCTAssertEqual(deliveries, (NSUInteger)1);
+    XCTAssertEqual(mergedCount, (NSUInteger)5);
+    XCTAssertEqualObjects(latestName, @"4");
+}
+
+
+- (void)testBatchedNotifications
+{
+    dispatch_queue_t queue = dispatch_queue_create("batching test", DISPATCH_QUEUE_SERIAL);
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Batched Notifications"];
+    NSMutableArray *batchSizes = [NSMutableArray array];
+    NSMutableArray *userInfos = [NSMutableArray array];
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"batch" onGCDQueue:queue withBatchBlock:^(id obj, NSArray *observations) {
+        [batchSizes addObject:@(observations.count)];
+        for (TONotificationObservation *obs in observations) {
+            XCTAssertNotNil(obs.sourceObservation);
+            [userInfos addObject:obs.userInfo];
+        }
+        if (userInfos.count == 5)
+            [expectation fulfill];
+    }];
+    observation.maximumBatchSize = 2;
+    
+    dispatch_suspend(queue); // let all the notifications accumulate
+    for (NSUInteger i = 0; i < 5; ++i) {
+        [self.modelObject to_postNotificationNamed:@"batch" userInfo:@{@"i": @(i)}];
+    }
+    dispatch_resume(queue);
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqualObjects(batchSizes, (@[@2, @2, @1]));
+    XCTAssertEqualObjects([userInfos valueForKey:@"i"], (@[@0, @1, @2, @3, @4]));
+}
+
+
+- (void)testEventCopiesOnConcurrentQueue
+{
+    dispatch_queue_t queue = dispatch_queue_create("event copies test", DISPATCH_QUEUE_CONCURRENT);
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Event Copies"];
+    NSMutableSet *receivedIndexes = [NSMutableSet set];
+    TOObservation * __block __weak weakObservation = nil;
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"events" onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+        XCTAssertNotEqual(obs, weakObservation);
+        XCTAssertEqual(obs.sourceObservation, weakObservation);
+        NSNumber *i = ((TONotificationObservation *)obs).userInfo[@"i"];
+        [NSThread sleepForTimeInterval:0.001]; // give later deliveries the chance to overlap this one
+        XCTAssertEqualObjects(((TONotificationObservation *)obs).userInfo[@"i"], i);
+        @synchronized(receivedIndexes) {
+            [receivedIndexes addObject:i];
+            if (receivedIndexes.count == 20)
+                [expectation fulfill];
+        }
+    }];
+    weakObservation = observation;
+    observation.deliversEventCopies = YES;
+    
+    dispatch_suspend(queue); // let all the notifications accumulate, then run at once
+    for (NSUInteger i = 0; i < 20; ++i) {
+        [self.modelObject to_postNotificationNamed:@"events" userInfo:@{@"i": @(i)}];
+    }
+    dispatch_resume(queue);
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertNil(((TONotificationObservation *)observation).userInfo); // the original is never written to
+}
+
+
+- (void)testSteadyStateDeliveryToGCDQueueDoesntAllocate
+{
+    dispatch_queue_t queue = dispatch_queue_create("allocation test", DISPATCH_QUEUE_SERIAL);
+    dispatch_semaphore_t delivered = dispatch_semaphore_create(0);
+    NSUInteger __block deliveries = 0;
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"allocations" onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+        ++deliveries;
+        dispatch_semaphore_signal(delivered);
+    }];
+    
+    // made ahead of time & passed straight to the observation, leaving out the notification center's own allocations
+    NSNotification *notification = [NSNotification notificationWithName:@"allocations" object:self.modelObject userInfo:@{@"i": @0}];
+    void (^trigger)(NSUInteger) = ^(NSUInteger count) {
+        for (NSUInteger i = 0; i < count; ++i) {
+            [(TONotificationObservation *)observation handleNotification:notification];
+            dispatch_semaphore_wait(delivered, DISPATCH_TIME_FOREVER);
+        }
+    };
+    trigger(100); // until the observation has all it needs to reuse
+    
+    TestMallocLogger *previousLogger = malloc_logger;
+    TestCountedAllocationThread = pthread_self();
+    atomic_store(&TestCountedAllocations, 0);
+    malloc_logger = TestCountAllocation;
+    trigger(1000);
+    malloc_logger = previousLogger;
+    
+    dispatch_sync(queue, ^{ });
+    XCTAssertEqual(deliveries, (NSUInteger)1100);
+    XCTAssertEqualObjects(((TONotificationObservation *)observation).userInfo, @{@"i": @0});
+    // GCD may now and then refill its own caches, but nothing should be allocated for each trigger
+    XCTAssertLessThan(atomic_load(&TestCountedAllocations), (NSUInteger)10);
+}
+
+
+- (void)testTargetQueueExecutorRunsInlineOnItsQueue
+{
+    dispatch_queue_t queue = dispatch_queue_create("target queue test", DISPATCH_QUEUE_SERIAL);
+    NSUInteger __block deliveries = 0;
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"target" onExecutor:[[TOTargetQueueExecutor alloc] initWithQueue:queue] withBlock:^(id obj, TOObservation *obs) {
+        ++deliveries;
+    }];
+    XCTAssertEqual(observation.gcdQueue, queue);
+    XCTAssertThrows(observation.executor = nil); // already registered
+    
+    dispatch_sync(queue, ^{
+        [self.modelObject to_postNotificationNamed:@"target"];
+        XCTAssertEqual(deliveries, (NSUInteger)1); // called without leaving the queue
+    });
+    
+    dispatch_suspend(queue);
+    [self.modelObject to_postNotificationNamed:@"target"];
+    XCTAssertEqual(deliveries, (NSUInteger)1); // hops onto the queue as usual
+    dispatch_resume(queue);
+    dispatch_sync(queue, ^{ });
+    XCTAssertEqual(deliveries, (NSUInteger)2);
+}
+
+- (void)testCoalescedDeliveryKeepsTargetQueueFastPath
+{
+    dispatch_queue_t queue = dispatch_queue_create("coalesced target queue test", DISPATCH_QUEUE_SERIAL);
+    NSUInteger __block deliveries = 0;
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"target" onExecutor:[[TOTargetQueueExecutor alloc] initWithQueue:queue] withBlock:^(id obj, TOObservation *obs) {
+        ++deliveries;
+    }];
+    observation.coalescesDeliveries = YES;
+    
+    // goes through the executor rather than a dispatch source on its queue, so still isn't deferred
+    dispatch_sync(queue, ^{
+        [self.modelObject to_postNotificationNamed:@"target"];
+        XCTAssertEqual(deliveries, (NSUInteger)1);
+    });
+}
+
+- (void)testThreadPoolExecutor
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Thread Pool"];
+    NSMutableSet *receivedIndexes = [NSMutableSet set];
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"pool" onExecutor:[[TOThreadPoolExecutor alloc] initWithThreadCount:4] withBlock:^(id obj, TOObservation *obs) {
+        XCTAssertFalse([NSThread isMainThread]);
+        @synchronized(receivedIndexes) {
+            [receivedIndexes addObject:((TONotificationObservation *)obs).userInfo[@"i"]];
+            if (receivedIndexes.count == 20)
+                [expectation fulfill];
+        }
+    }];
+    observation.deliversEventCopies = YES;
+    XCTAssertNil(observation.queue);
+    XCTAssertNil(observation.gcdQueue);
+    
+    for (NSUInteger i = 0; i < 20; ++i) {
+        [self.modelObject to_postNotificationNamed:@"pool" userInfo:@{@"i": @(i)}];
+    }
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+}
+
+
+- (void)testWorkStealingSerialExecutorKeepsOrder
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Work Stealing"];
+    TOWorkStealingExecutor *executor = [[TOWorkStealingExecutor alloc] initWithThreadCount:4];
+    NSMutableArray *firstIndexes = [NSMutableArray array];
+    NSMutableArray *secondIndexes = [NSMutableArray array];
+    NSUInteger __block finishedCount = 0;
+    for (NSMutableArray *indexes in @[firstIndexes, secondIndexes]) {
+        [self to_observeForNotifications:self.modelObject named:@"ordered" onExecutor:[executor serialExecutor] withBlock:^(id obj, TOObservation *obs) {
+            [indexes addObject:((TONotificationObservation *)obs).userInfo[@"i"]]; // serial executor, so never concurrently
+            if (indexes.count == 200) {
+                @synchronized(expectation) {
+                    if (++finishedCount == 2)
+                        [expectation fulfill];
+                }
+            }
+        }];
+    }
+    
+    NSMutableArray *expectedIndexes = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 200; ++i) {
+        [self.modelObject to_postNotificationNamed:@"ordered" userInfo:@{@"i": @(i)}];
+        [expectedIndexes addObject:@(i)];
+    }
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqualObjects(firstIndexes, expectedIndexes);
+    XCTAssertEqualObjects(secondIndexes, expectedIndexes);
+}
+
+
+- (NSArray *)deliveredIndexesWithOverflowPolicy:(TODeliveryOverflowPolicy)policy droppedCount:(NSUInteger *)droppedCount
+{
+    dispatch_queue_t queue = dispatch_queue_create("overflow test", DISPATCH_QUEUE_SERIAL);
+    NSMutableArray *indexes = [NSMutableArray array];
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"overflow" onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+        [indexes addObject:((TONotificationObservation *)obs).userInfo[@"i"]];
+    }];
+    observation.maximumPendingDeliveries = 3;
+    observation.deliveryOverflowPolicy = policy;
+    
+    dispatch_suspend(queue); // stalled consumer
+    for (NSUInteger i = 0; i < 10; ++i) {
+        [self.modelObject to_postNotificationNamed:@"overflow" userInfo:@{@"i": @(i)}];
+    }
+    dispatch_resume(queue);
+    dispatch_sync(queue, ^{ });
+    
+    *droppedCount = observation.droppedTriggerCount;
+    [observation remove];
+    return indexes;
+}
+
+- (void)testBoundedDeliveryDropsOldest
+{
+    NSUInteger dropped = 0;
+    NSArray *indexes = [self deliveredIndexesWithOverflowPolicy:TODeliveryOverflowPolicyDropOldest droppedCount:&dropped];
+    XCTAssertEqualObjects(indexes, (@[@7, @8, @9]));
+    XCTAssertEqual(dropped, (NSUInteger)7);
+}
+
+- (void)testBoundedDeliveryDropsNewest
+{
+    NSUInteger dropped = 0;
+    NSArray *indexes = [self deliveredIndexesWithOverflowPolicy:TODeliveryOverflowPolicyDropNewest droppedCount:&dropped];
+    XCTAssertEqualObjects(indexes, (@[@0, @1, @2]));
+    XCTAssertEqual(dropped, (NSUInteger)7);
+}
+
+- (void)testDeliveryDeadlineShedsStaleTriggers
+{
+    dispatch_queue_t queue = dispatch_queue_create("deadline test", DISPATCH_QUEUE_SERIAL);
+    NSMutableArray *indexes = [NSMutableArray array];
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"deadline" onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+        [indexes addObject:((TONotificationObservation *)obs).userInfo[@"i"]];
+    }];
+    observation.maximumDeliveryDelay = 0.05;
+    
+    dispatch_suspend(queue);
+    [self.modelObject to_postNotificationNamed:@"deadline" userInfo:@{@"i": @0}];
+    [NSThread sleepForTimeInterval:0.1];
+    [self.modelObject to_postNotificationNamed:@"deadline" userInfo:@{@"i": @1}];
+    dispatch_resume(queue);
+    dispatch_sync(queue, ^{ });
+    
+    XCTAssertEqualObjects(indexes, (@[@1]));
+    XCTAssertEqual(observation.droppedTriggerCount, (NSUInteger)1);
+}
+
+
+- (void)testRemoveCancelsQueuedDeliveries
+{
+    dispatch_queue_t queue = dispatch_queue_create("remove test", DISPATCH_QUEUE_SERIAL);
+    __block NSUInteger deliveries = 0;
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"remove" onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+        ++deliveries;
+    }];
+    
+    dispatch_suspend(queue);
+    for (NSUInteger i = 0; i < 5; ++i) {
+        [self.modelObject to_postNotificationNamed:@"remove" userInfo:@{@"i": @(i)}];
+    }
+    [observation remove];
+    dispatch_resume(queue);
+    dispatch_sync(queue, ^{ });
+    
+    XCTAssertEqual(deliveries, (NSUInteger)0);
+}
+
+- (void)testRemoveReleasesBlockedTrigger
+{
+    dispatch_queue_t queue = dispatch_queue_create("blocked test", DISPATCH_QUEUE_SERIAL);
+    __block NSUInteger deliveries = 0;
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"blocked" onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+        ++deliveries;
+    }];
+    observation.maximumPendingDeliveries = 1;
+    observation.deliveryOverflowPolicy = TODeliveryOverflowPolicyBlockTrigger;
+    
+    dispatch_suspend(queue); // the drain never runs, so only removal can make room
+    [self.modelObject to_postNotificationNamed:@"blocked"];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.1 * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+        [observation remove];
+    });
+    [self.modelObject to_postNotificationNamed:@"blocked"]; // blocks until removed
+    XCTAssertFalse(observation.registered);
+    dispatch_resume(queue);
+    dispatch_sync(queue, ^{ });
+    
+    XCTAssertEqual(deliveries, (NSUInteger)0);
+    XCTAssertEqual(observation.droppedTriggerCount, (NSUInteger)0);
+}
+
+
+- (void)assertDeliveryWithExecutor:(id<TOExecutor>)executor runsAtQualityOfService:(NSQualityOfService)qualityOfService expectedClass:(qos_class_t)expectedClass
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"QoS"];
+    __block qos_class_t deliveredClass = QOS_CLASS_UNSPECIFIED;
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"qos" onExecutor:executor withBlock:^(id obj, TOObservation *obs) {
+        deliveredClass = qos_class_self();
+        [expectation fulfill];
+    }];
+    observation.qualityOfService = qualityOfService;
+    
+    [self.modelObject to_postNotificationNamed:@"qos"];
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqual(deliveredClass, expectedClass);
+    [observation remove];
+}
+
+- (void)testQualityOfServiceHonoredByExecutors
+{
+    dispatch_queue_t queue = dispatch_queue_create("qos test", DISPATCH_QUEUE_SERIAL);
+    [self assertDeliveryWithExecutor:[[TOGCDQueueExecutor alloc] initWithQueue:queue] runsAtQualityOfService:NSQualityOfServiceUtility expectedClass:QOS_CLASS_UTILITY];
+    
+    NSOperationQueue *operationQueue = [[NSOperationQueue alloc] init];
+    [self assertDeliveryWithExecutor:[[TOOperationQueueExecutor alloc] initWithOperationQueue:operationQueue] runsAtQualityOfService:NSQualityOfServiceBackground expectedClass:QOS_CLASS_BACKGROUND];
+    
+    TOThreadPoolExecutor *pool = [[TOThreadPoolExecutor alloc] initWithThreadCount:1];
+    [self assertDeliveryWithExecutor:pool runsAtQualityOfService:NSQualityOfServiceUtility expectedClass:QOS_CLASS_UTILITY];
+    [self assertDeliveryWithExecutor:pool runsAtQualityOfService:NSQualityOfServiceUserInitiated expectedClass:QOS_CLASS_USER_INITIATED];
+    
+    TOWorkStealingExecutor *workStealing = [[TOWorkStealingExecutor alloc] initWithThreadCount:2];
+    [self assertDeliveryWithExecutor:workStealing.serialExecutor runsAtQualityOfService:NSQualityOfServiceBackground expectedClass:QOS_CLASS_BACKGROUND];
+    
+    TOFairQueueScheduler *scheduler = [[TOFairQueueScheduler alloc] initWithQueue:dispatch_queue_create("fair qos test", DISPATCH_QUEUE_SERIAL)];
+    [self assertDeliveryWithExecutor:[scheduler executorWithWeight:1] runsAtQualityOfService:NSQualityOfServiceUtility expectedClass:QOS_CLASS_UTILITY];
+}
+
+
+- (void)testFairQueueSchedulerInterleavesQuietObservation
+{
+    dispatch_queue_t queue = dispatch_queue_create("fair test", DISPATCH_QUEUE_SERIAL);
+    TOFairQueueScheduler *scheduler = [[TOFairQueueScheduler alloc] initWithQueue:queue];
+    NSMutableArray *names = [NSMutableArray array];
+    [self to_observeForNotifications:self.modelObject named:@"noisy" onExecutor:[scheduler executorWithWeight:2] withBlock:^(id obj, TOObservation *obs) {
+        [names addObject:@"noisy"];
+    }];
+    [self to_observeForNotifications:self.modelObject named:@"quiet" onExecutor:[scheduler executorWithWeight:1] withBlock:^(id obj, TOObservation *obs) {
+        [names addObject:@"quiet"];
+    }];
+    
+    dispatch_suspend(queue);
+    for (NSUInteger i = 0; i < 1000; ++i) {
+        [self.modelObject to_postNotificationNamed:@"noisy"];
+    }
+    [self.modelObject to_postNotificationNamed:@"quiet"];
+    dispatch_resume(queue);
+    
+    // one drain of the queue runs a limited number of items, so wait for all of them
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:2.0];
+    __block NSUInteger count = 0;
+    while (count < 1001 && [timeout timeIntervalSinceNow] > 0) {
+        dispatch_sync(queue, ^{ count = names.count; });
+    }
+    
+    XCTAssertEqual(count, (NSUInteger)1001);
+    XCTAssertEqual([names indexOfObject:@"quiet"], (NSUInteger)2); // after the noisy observation's first turn of 2
+}
+
+
+- (void)testShardedUnqueuedDeliveryKeepsOrder
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Sharded"];
+    NSMutableArray *firstIndexes = [NSMutableArray array];
+    NSMutableArray *secondIndexes = [NSMutableArray array];
+    NSUInteger __block finishedCount = 0;
+    [TOObservation setShardsUnqueuedDeliveries:YES];
+    for (NSMutableArray *indexes in @[firstIndexes, secondIndexes]) {
+        TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"sharded" withBlock:^(id obj, TOObservation *obs) {
+            XCTAssertFalse([NSThread isMainThread]);
+            [indexes addObject:((TONotificationObservation *)obs).userInfo[@"i"]]; // serial shard, so never concurrently
+            if (indexes.count == 100) {
+                @synchronized(expectation) {
+                    if (++finishedCount == 2)
+                        [expectation fulfill];
+                }
+            }
+        }];
+        observation.deliversEventCopies = YES;
+        XCTAssertNotNil(observation.executor);
+    }
+    [TOObservation setShardsUnqueuedDeliveries:NO];
+    
+    NSMutableArray *expectedIndexes = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 100; ++i) {
+        [self.modelObject to_postNotificationNamed:@"sharded" userInfo:@{@"i": @(i)}];
+        [expectedIndexes addObject:@(i)];
+    }
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqualObjects(firstIndexes, expectedIndexes);
+    XCTAssertEqualObjects(secondIndexes, expectedIndexes);
+}
+
+
+- (void)testLeadingThrottleDropsBurst
+{
+    dispatch_queue_t queue = dispatch_queue_create("throttle", DISPATCH_QUEUE_SERIAL);
+    dispatch_suspend(queue);
+    NSMutableArray *indexes = [NSMutableArray array];
+    [self to_observeForNotifications:self.modelObject named:@"throttle" onGCDQueue:queue rateLimit:TORateLimitThrottleLeading interval:10.0 withBlock:^(id obj, TOObservation *obs) {
+        [indexes addObject:((TONotificationObservation *)obs).userInfo[@"i"]];
+    }];
+    
+    for (NSUInteger i = 0; i < 5; ++i) {
+        [self.modelObject to_postNotificationNamed:@"throttle" userInfo:@{@"i": @(i)}];
+    }
+    dispatch_resume(queue);
+    dispatch_sync(queue, ^{});
+    XCTAssertEqualObjects(indexes, @[@0]);
+}
+
+
+- (void)testDebounceDeliversOnlyLatestTrigger
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Debounce"];
+    dispatch_queue_t queue = dispatch_queue_create("debounce", DISPATCH_QUEUE_SERIAL);
+    NSMutableArray *indexes = [NSMutableArray array];
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"debounce" onGCDQueue:queue rateLimit:TORateLimitDebounce interval:0.05 withBlock:^(id obj, TOObservation *obs) {
+        [indexes addObject:((TONotificationObservation *)obs).userInfo[@"i"]];
+        [expectation fulfill];
+    }];
+    observation.deliversEventCopies = YES;
+    
+    for (NSUInteger i = 0; i < 5; ++i) {
+        [self.modelObject to_postNotificationNamed:@"debounce" userInfo:@{@"i": @(i)}];
+    }
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    dispatch_sync(queue, ^{});
+    XCTAssertEqualObjects(indexes, @[@4]);
+}
+
+
+- (void)testWatchdogFiresOnceAfterSilence
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Watchdog"];
+    dispatch_queue_t queue = dispatch_queue_create("watchdog", DISPATCH_QUEUE_SERIAL);
+    NSUInteger __block firedCount = 0;
+    NSDate *__block lastPostDate = nil;
+    NSDate *__block firedDate = nil;
+    TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"watchdog" onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+    }];
+    [observation startWatchdogWithThreshold:0.1 block:^(TOObservation *obs, NSTimeInterval silence) {
+        XCTAssertGreaterThanOrEqual(silence, 0.1);
+        @synchronized(expectation) {
+            firedDate = [NSDate date];
+            if (++firedCount == 1)
+                [expectation fulfill];
+        }
+    }];
+    
+    // triggers closer together than the threshold keep it quiet
+    for (NSUInteger i = 0; i < 4; ++i) {
+        @synchronized(expectation) {
+            lastPostDate = [NSDate date];
+        }
+        [self.modelObject to_postNotificationNamed:@"watchdog"];
+        usleep(40000);
+    }
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    usleep(250000);
+    @synchronized(expectation) {
+        XCTAssertEqual(firedCount, (NSUInteger)1);
+        XCTAssertGreaterThanOrEqual([firedDate timeIntervalSinceDate:lastPostDate], 0.1);
+    }
+    [observation remove];
+}
+
+- (void)testBagRemoveAllStopsWatchdog
+{
+    NSUInteger __block firedCount = 0;
+    TOObservationBag *bag = [[TOObservationBag alloc] init];
+    [bag addObservationsWithBlock:^{
+        TOObservation *observation = [self to_observeForNotifications:self.modelObject named:@"watchdog" withBlock:^(id obj, TOObservation *obs) {
+        }];
+        [observation startWatchdogWithThreshold:0.05 block:^(TOObservation *obs, NSTimeInterval silence) {
+            @synchronized(bag) {
+                ++firedCount;
+            }
+        }];
+    }];
+    [self.modelObject to_postNotificationNamed:@"watchdog"];
+    [bag removeAll];
+    
+    usleep(150000);
+    @synchronized(bag) {
+        XCTAssertEqual(firedCount, (NSUInteger)0);
+    }
+}
+
+
+- (void)testAggregatedDeliveriesShareOneDrain
+{
+    // the main queue can't run anything until this method waits below, so it's effectively suspended until then
+    dispatch_queue_t queue = dispatch_get_main_queue();
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Aggregated"];
+    NSMutableArray *order = [NSMutableArray array];
+    [TOObservation setAggregatesQueuedDeliveries:YES];
+    TOObservation *first = [self to_observeForNotifications:self.modelObject named:@"aggregatedFirst" onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+        [order addObject:@"first"];
+    }];
+    TOObservation *second = [self to_observeForNotifications:self.modelObject named:@"aggregatedSecond" onGCDQueue:queue withBlock:^(id obj, TOObservation *obs) {
+        [order addObject:@"second"];
+    }];
+    TOObservation *concurrent = [self to_observeForNotifications:self.modelObject named:@"aggregatedConcurrent" onGCDQueue:dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0) withBlock:^(id obj, TOObservation *obs) {
+    }];
+    [TOObservation setAggregatesQueuedDeliveries:NO];
+    XCTAssertTrue([first.executor isKindOfClass:[TOAggregatingExecutor class]]);
+    XCTAssertEqual(first.executor, second.executor);
+    XCTAssertEqual(first.gcdQueue, queue);
+    XCTAssertFalse([concurrent.executor isKindOfClass:[TOAggregatingExecutor class]]); // would be serialized by one drain
+    
+    // the second delivery joins the drain scheduled by the first, so runs ahead of work given to the queue between them
+    [self.modelObject to_postNotificationNamed:@"aggregatedFirst"];
+    dispatch_async(queue, ^{
+        [order addObject:@"direct"];
+        [expectation fulfill];
+    });
+    [self.modelObject to_postNotificationNamed:@"aggregatedSecond"];
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqualObjects(order, (@[@"first", @"second", @"direct"]));
+    [first remove];
+    [second remove];
+    [concurrent remove];
+}
+
 @end
@@ -74,6 +74,25 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (TO_nullable TOAppGroupObservation *)to_observeAppGroupNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBlock:(TOObservationBlock)block;
 
+/**
+ *  Receiver observes app group notifications posted with given name, calling its block on the given GCD dispatch queue
+ *  at a limited rate.
+ *
+ *  Variation on `to_observeAppGroupNotificationsNamed:onGCDQueue:withBlock:` that limits how often its block is called,
+ *  applying `rateLimit` and `interval` to posts before they're passed to the queue. See the description for that
+ *  method, and the `rateLimit` property of `TOObservation`.
+ *
+ *  @param name      The notification name to observe.
+ *  @param queue     The GCD dispatch queue on which to call `block`.
+ *  @param rateLimit How to limit the rate of calls to `block`.
+ *  @param interval  The interval used by `rateLimit`.
+ *  @param block     The block to call when the observation is triggered, is passed the receiver (which can be used
+ *                   in place of a weakly captured self), and the observation (same as method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOAppGroupObservation *)to_observeAppGroupNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block;
+
 
 /**
  *  Receiver observes notifications on a given name within the default app group, such that all posts sent are recevied
@@ -236,6 +255,26 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (TO_nullable TOAppGroupObservation *)to_observeNotificationsForAppGroup:(NSString *)groupIdentifier named:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBlock:(TOObservationBlock)block;
 
+/**
+ *  Receiver observes notifications posted with given name within the given app group, calling its block on the given
+ *  GCD dispatch queue at a limited rate.
+ *
+ *  Variation on `to_observeNotificationsForAppGroup:named:onGCDQueue:withBlock:` that limits how often its block is
+ *  called, applying `rateLimit` and `interval` to posts before they're passed to the queue. See the description for
+ *  that method, and the `rateLimit` property of `TOObservation`.
+ *
+ *  @param groupIdentifier The identifier string for your app group.
+ *  @param name            The notification name to observe.
+ *  @param queue           The GCD dispatch queue on which to call `block`.
+ *  @param rateLimit       How to limit the rate of calls to `block`.
+ *  @param interval        The interval used by `rateLimit`.
+ *  @param block           The block to call when the observation is triggered, is passed the receiver (which can be
+ *                         used in place of a weakly captured self), and the observation (same as method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOAppGroupObservation *)to_observeNotificationsForAppGroup:(NSString *)groupIdentifier named:(NSString *)name onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block;
+
 
 /**
  *  Receiver observes notifications on a given name within the given app group, such that all posts sent are recevied
@@ -54,6 +54,15 @@ NS_ASSUME_NONNULL_BEGIN
     return observation;
 }
 
+- (nullable TOAppGroupObservation *)to_observeAppGroupNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block
+{
+    TOAppGroupObservation *observation = [[TOAppGroupObservation alloc] initWithObserver:self groupIdentifier:nil name:name queue:nil gcdQueue:queue block:block];
+    observation.rateLimit = rateLimit;
+    observation.rateLimitInterval = interval;
+    [observation register];
+    return observation;
+}
+
 - (nullable TOAppGroupObservation *)to_observeNotificationsForAppGroup:(NSString *)groupIdentifier named:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBlock:(TOObservationBlock)block
 {
     TOAppGroupObservation *observation = [[TOAppGroupObservation alloc] initWithObserver:self groupIdentifier:groupIdentifier name:name queue:nil gcdQueue:queue block:block];
@@ -61,6 +70,15 @@ NS_ASSUME_NONNULL_BEGIN
     return observation;
 }
 
+- (nullable TOAppGroupObservation *)to_observeNotificationsForAppGroup:(NSString *)groupIdentifier named:(NSString *)name onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block
+{
+    TOAppGroupObservation *observation = [[TOAppGroupObservation alloc] initWithObserver:self groupIdentifier:groupIdentifier name:name queue:nil gcdQueue:queue block:block];
+    observation.rateLimit = rateLimit;
+    observation.rateLimitInterval = interval;
+    [observation register];
+    return observation;
+}
+
 
 - (BOOL)to_stopObservingAppGroupNotificationsNamed:(NSString *)name
 {
@@ -15,19 +15,6 @@ NS_ASSUME_NONNULL_BEGIN
 #define TO_nullable
 #endif
 
-/**
- *  A block called when an observation is triggered with potentially multiple results are available at once.
- *
- *  @param obj          The observing object. Often this can be used in place of a weak `self` capture.
- *  @param observations Array of the triggered observation objects. Details about the observation that was
- *                      triggered, plus any payload or associated metadata will be properties of this object.
- *                      Some objects in the array may be a copies of the original instance that represents the
- *                      overall observation. Any of these copies will forward the `remove` method call to the
- *                      original observer instance.
- */
-typedef void (^TOCollatedObservationBlock)(id obj, NSArray *observations);
-
-
 /**
  *  A base class for App Group Notification observation objects.
  *
@@ -68,11 +68,44 @@ NS_ASSUME_NONNULL_BEGIN
     return copy;
 }
 
+- (nullable instancetype)eventCopy
+{
+    TOAppGroupObservation *copy = [self copy];
+    copy.sourceObservation = self;
+    return copy;
+}
+
+- (void)takePayload:(nullable id)payload postedDate:(NSDate *)postedDate groupIdentifier:(NSString *)groupIdentifier
+{
+    self.payload = payload;
+    self.postedDate = postedDate;
+    if (self.groupIdentifier == nil || ![self.groupIdentifier isEqualToString:groupIdentifier]) {
+        self.groupIdentifier = groupIdentifier;
+    }
+}
+
+- (void)takeEventFromCopy:(TOObservation *)event
+{
+    TOAppGroupObservation *copy = (TOAppGroupObservation *)event;
+    [self takePayload:copy.payload postedDate:copy.postedDate groupIdentifier:copy.groupIdentifier];
+}
+
+- (void)clearEvent
+{
+    self.payload = nil; // the date and identifier are left, they're small and often the same next time
+}
+
 - (BOOL)isReliable
 {
     return self.collatedBlock != nil;
 }
 
+- (BOOL)coalescesDeliveries
+{
+    // reliable observations pass every post to their block, merging deliveries would drop all but the latest batch
+    return super.coalescesDeliveries && !self.reliable;
+}
+
 - (void)remove
 {
     if (self.originalObservation != nil) {
@@ -142,12 +175,8 @@ NS_ASSUME_NONNULL_BEGIN
     else
     {
         ok = [appGroupNotificationManager subscribeToNotificationsForGroupIdentifier:groupIdentifier named:self.name withBlock:^(NSString *identifier, NSString *name, id payload, NSDate *postDate) {
-            [self invokeOnQueueAfter:^{
-                self.payload = payload;
-                self.postedDate = postDate;
-                if (self.groupIdentifier == nil || ![self.groupIdentifier isEqualToString:groupIdentifier]) {
-                    self.groupIdentifier = groupIdentifier;
-                }
+            [self invokeOnQueueForEvent:^(TOAppGroupObservation *observation) {
+                [observation takePayload:payload postedDate:postDate groupIdentifier:groupIdentifier];
             }];
         }];
     }
@@ -187,6 +216,17 @@ NS_ASSUME_NONNULL_BEGIN
     }
 }
 
++ (NSString *)hashKeyForName:(NSString *)name
+{
+    // group identifier isn't part of the key since it can still be nil when the observation is stored, matched instead by test block
+    return [@"appgroup|" stringByAppendingString:name];
+}
+
+- (nullable NSString *)hashKey
+{
+    return [TOAppGroupObservation hashKeyForName:self.name];
+}
+
 + (BOOL)removeForObserver:(id)observer groupIdentifier:(nullable NSString *)identifier name:(NSString *)name
 {
     return [self removeForObserver:observer groupIdentifier:identifier name:name updatingRetainStateMode:nil]; // nil to use the default retaining behavior
@@ -205,7 +245,7 @@ NS_ASSUME_NONNULL_BEGIN
         return NO;
     }
     
-    TOAppGroupObservation *observation = (TOAppGroupObservation *)[self findObservationForObserver:observer object:nil matchingTest:^BOOL(TOObservation *observation) {
+    TOAppGroupObservation *observation = (TOAppGroupObservation *)[self findObservationForObserver:observer object:nil hashKey:[TOAppGroupObservation hashKeyForName:name] matchingTest:^BOOL(TOObservation *observation) {
         TOAppGroupObservation *groupObservation = (TOAppGroupObservation *)observation;
         return [observation isKindOfClass:[TOAppGroupObservation class]] && [name isEqualToString:groupObservation.name] && [groupIdentifier isEqualToString:groupObservation.groupIdentifier];
     }];
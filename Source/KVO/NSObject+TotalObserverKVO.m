@@ -8,6 +8,7 @@
 
 #import "NSObject+TotalObserverKVO.h"
 #import "TOKVOObservation+Private.h"
+#import "TOKVOScalarObservation+Private.h"
 #import "TOObservation+Private.h"
 
 #if __has_feature(nullability)
@@ -81,6 +82,29 @@ NS_ASSUME_NONNULL_BEGIN
     return observation;
 }
 
+- (nullable TOKVOObservation *)to_observeForChanges:(id)object toKeyPath:(NSString *)keyPath options:(int)options onQueue:(NSOperationQueue *)queue withBatchBlock:(TOCollatedObservationBlock)block
+{
+    TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObserver:self object:object keyPaths:@[keyPath] options:options queue:queue gcdQueue:nil batchBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeForChanges:(id)object toKeyPath:(NSString *)keyPath options:(int)options onGCDQueue:(dispatch_queue_t)queue withBatchBlock:(TOCollatedObservationBlock)block
+{
+    TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObserver:self object:object keyPaths:@[keyPath] options:options queue:nil gcdQueue:queue batchBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeForChanges:(id)object toKeyPath:(NSString *)keyPath onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block
+{
+    TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObserver:self object:object keyPaths:@[keyPath] options:0 queue:nil gcdQueue:queue block:block];
+    observation.rateLimit = rateLimit;
+    observation.rateLimitInterval = interval;
+    [observation register];
+    return observation;
+}
+
 - (nullable TOKVOObservation *)to_observeForChanges:(id)object toKeyPaths:(NSArray *)keyPaths options:(int)options onGCDQueue:(dispatch_queue_t)queue withBlock:(TOObservationBlock)block
 {
     TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObserver:self object:object keyPaths:keyPaths options:options queue:nil gcdQueue:queue block:block];
@@ -166,6 +190,29 @@ NS_ASSUME_NONNULL_BEGIN
     return observation;
 }
 
+- (nullable TOKVOObservation *)to_observeOwnChangesToKeyPath:(NSString *)keyPath options:(int)options onQueue:(NSOperationQueue *)queue withBatchBlock:(TOCollatedObservationBlock)block
+{
+    TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObserver:self object:self keyPaths:@[keyPath] options:options queue:queue gcdQueue:nil batchBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeOwnChangesToKeyPath:(NSString *)keyPath options:(int)options onGCDQueue:(dispatch_queue_t)queue withBatchBlock:(TOCollatedObservationBlock)block
+{
+    TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObserver:self object:self keyPaths:@[keyPath] options:options queue:nil gcdQueue:queue batchBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeOwnChangesToKeyPath:(NSString *)keyPath onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block
+{
+    TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObserver:self object:self keyPaths:@[keyPath] options:0 queue:nil gcdQueue:queue block:block];
+    observation.rateLimit = rateLimit;
+    observation.rateLimitInterval = interval;
+    [observation register];
+    return observation;
+}
+
 - (nullable TOKVOObservation *)to_observeOwnChangesToKeyPaths:(NSArray *)keyPaths options:(int)options onGCDQueue:(dispatch_queue_t)queue withBlock:(TOObservationBlock)block
 {
     TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObserver:self object:self keyPaths:keyPaths options:options queue:nil gcdQueue:queue block:block];
@@ -273,6 +320,81 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 
+- (nullable TOKVOObservation *)to_observeChangesToKeyPath:(NSString *)keyPath distinct:(TODistinctComparison)comparison withBlock:(TOAnonymousObservationBlock)block
+{
+    TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObject:self keyPaths:@[keyPath] options:0 queue:nil gcdQueue:nil block:block];
+    observation.distinctUntilChanged = comparison;
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeChangesToKeyPath:(NSString *)keyPath distinct:(TODistinctComparison)comparison onGCDQueue:(dispatch_queue_t)queue withBlock:(TOAnonymousObservationBlock)block
+{
+    TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObject:self keyPaths:@[keyPath] options:0 queue:nil gcdQueue:queue block:block];
+    observation.distinctUntilChanged = comparison;
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeChangesToKeyPaths:(NSArray *)keyPaths distinct:(TODistinctComparison)comparison withBlock:(TOAnonymousObservationBlock)block
+{
+    TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObject:self keyPaths:keyPaths options:0 queue:nil gcdQueue:nil block:block];
+    observation.distinctUntilChanged = comparison;
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeChangesToKeyPaths:(NSArray *)keyPaths distinct:(TODistinctComparison)comparison onGCDQueue:(dispatch_queue_t)queue withBlock:(TOAnonymousObservationBlock)block
+{
+    TOKVOObservation *observation = [[TOKVOObservation alloc] initWithObject:self keyPaths:keyPaths options:0 queue:nil gcdQueue:queue block:block];
+    observation.distinctUntilChanged = comparison;
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeDoubleChangesToKeyPath:(NSString *)key withBlock:(TODoubleObservationBlock)block
+{
+    TOKVOScalarObservation *observation = [[TOKVOScalarObservation alloc] initWithObject:self key:key queue:nil gcdQueue:nil doubleBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeDoubleChangesToKeyPath:(NSString *)key onGCDQueue:(dispatch_queue_t)queue withBlock:(TODoubleObservationBlock)block
+{
+    TOKVOScalarObservation *observation = [[TOKVOScalarObservation alloc] initWithObject:self key:key queue:nil gcdQueue:queue doubleBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeIntegerChangesToKeyPath:(NSString *)key withBlock:(TOIntegerObservationBlock)block
+{
+    TOKVOScalarObservation *observation = [[TOKVOScalarObservation alloc] initWithObject:self key:key queue:nil gcdQueue:nil integerBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeIntegerChangesToKeyPath:(NSString *)key onGCDQueue:(dispatch_queue_t)queue withBlock:(TOIntegerObservationBlock)block
+{
+    TOKVOScalarObservation *observation = [[TOKVOScalarObservation alloc] initWithObject:self key:key queue:nil gcdQueue:queue integerBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeBoolChangesToKeyPath:(NSString *)key withBlock:(TOBoolObservationBlock)block
+{
+    TOKVOScalarObservation *observation = [[TOKVOScalarObservation alloc] initWithObject:self key:key queue:nil gcdQueue:nil boolBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TOKVOObservation *)to_observeBoolChangesToKeyPath:(NSString *)key onGCDQueue:(dispatch_queue_t)queue withBlock:(TOBoolObservationBlock)block
+{
+    TOKVOScalarObservation *observation = [[TOKVOScalarObservation alloc] initWithObject:self key:key queue:nil gcdQueue:queue boolBlock:block];
+    [observation register];
+    return observation;
+}
+
+
 - (BOOL)to_stopObservingForChanges:(id)object toKeyPath:(NSString *)keyPath
 {
     return [TOKVOObservation removeForObserver:self object:object keyPaths:@[keyPath]];
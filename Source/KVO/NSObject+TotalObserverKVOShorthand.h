@@ -10,6 +10,7 @@
 
 #import <Foundation/Foundation.h>
 #import "TOKVOObservation.h"
+#import "TOKVOScalarObservation.h"
 
 #if __has_feature(nullability)
 NS_ASSUME_NONNULL_BEGIN
@@ -123,6 +124,64 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (TO_nullable TOKVOObservation *)observeForChanges:(id)object toKeyPath:(NSString *)keyPath options:(int)options onGCDQueue:(dispatch_queue_t)queue withBlock:(TOObservationBlock)block;
 
+/**
+ *  Receiver observes a KVO key path on the given object with options, calling its batch block on the given operation
+ *  queue with all the changes that occur while waiting for that queue.
+ *
+ *  Variation on `observeForChanges:toKeyPath:options:onQueue:withBlock:` whose block is passed an array of
+ *  observations, one for each change in the order they occurred, instead of being called once per change. See the
+ *  description for that method, and the `batchBlock` property of `TOObservation`.
+ *
+ *  @param object  The object to observe.
+ *  @param keyPath The key path string to observe on `object`.
+ *  @param options The KVO observation options.
+ *  @param queue   The operation queue on which to call `block`.
+ *  @param block   The block to call with each batch, is passed the receiver (which can be used in place of a weakly
+ *                 captured self), and an array of observation copies each describing one change.
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOKVOObservation *)observeForChanges:(id)object toKeyPath:(NSString *)keyPath options:(int)options onQueue:(NSOperationQueue *)queue withBatchBlock:(TOCollatedObservationBlock)block;
+
+/**
+ *  Receiver observes a KVO key path on the given object with options, calling its batch block on the given GCD dispatch
+ *  queue with all the changes that occur while waiting for that queue.
+ *
+ *  Variation on `observeForChanges:toKeyPath:options:onGCDQueue:withBlock:` whose block is passed an array of
+ *  observations, one for each change in the order they occurred, instead of being called once per change. See the
+ *  description for that method, and the `batchBlock` property of `TOObservation`.
+ *
+ *  @param object  The object to observe.
+ *  @param keyPath The key path string to observe on `object`.
+ *  @param options The KVO observation options.
+ *  @param queue   The GCD dispatch queue on which to call `block`.
+ *  @param block   The block to call with each batch, is passed the receiver (which can be used in place of a weakly
+ *                 captured self), and an array of observation copies each describing one change.
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOKVOObservation *)observeForChanges:(id)object toKeyPath:(NSString *)keyPath options:(int)options onGCDQueue:(dispatch_queue_t)queue withBatchBlock:(TOCollatedObservationBlock)block;
+
+/**
+ *  Receiver observes a KVO key path on the given object, calling its block on the given GCD dispatch queue at a limited
+ *  rate.
+ *
+ *  Variation on `observeForChanges:toKeyPath:onGCDQueue:withBlock:` that limits how often its block is called,
+ *  applying `rateLimit` and `interval` to changes before they're passed to the queue. See the description for that
+ *  method, and the `rateLimit` property of `TOObservation`.
+ *
+ *  @param object    The object to observe.
+ *  @param keyPath   The key path string to observe on `object`.
+ *  @param queue     The GCD dispatch queue on which to call `block`.
+ *  @param rateLimit How to limit the rate of calls to `block`.
+ *  @param interval  The interval used by `rateLimit`.
+ *  @param block     The block to call when the observation is triggered, is passed the receiver (which can be used
+ *                   in place of a weakly captured self), and the observation (same as method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOKVOObservation *)observeForChanges:(id)object toKeyPath:(NSString *)keyPath onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block;
+
 
 /**
  *  Receiver stops observing a KVO key path on the given object.
@@ -356,6 +415,39 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (TO_nullable TOKVOObservation *)observeChangesToKeyPath:(NSString *)keyPath options:(int)options onGCDQueue:(dispatch_queue_t)queue withBlock:(TOAnonymousObservationBlock)block;
 
+/**
+ *  Observe a KVO key path on the receiver, dropping changes that leave the value the same.
+ *
+ *  Variation on `observeChangesToKeyPath:withBlock:` that adds a `distinctUntilChanged` parameter, comparing each
+ *  change's old and new values on the triggering thread. See the description for that method, and for
+ *  `distinctUntilChanged`. A `distinctComparator` can be set on the result to compare values some other way.
+ *
+ *  @param keyPath    The key path string to observe on the receiver.
+ *  @param comparison How to tell that a change left the value the same.
+ *  @param block      The block to call when the key path observation is triggered, is passed the observation (same as
+ *                    the method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOKVOObservation *)observeChangesToKeyPath:(NSString *)keyPath distinct:(TODistinctComparison)comparison withBlock:(TOAnonymousObservationBlock)block;
+
+/**
+ *  Observe a KVO key path on the receiver, dropping changes that leave the value the same, calling its block on
+ *  the given GCD dispatch queue.
+ *
+ *  Variation on `observeChangesToKeyPath:distinct:withBlock:` that adds a GCD dispatch queue parameter. Unchanged
+ *  values are dropped before anything is dispatched to the queue. See the description for that method.
+ *
+ *  @param keyPath    The key path string to observe on the receiver.
+ *  @param comparison How to tell that a change left the value the same.
+ *  @param queue      The GCD dispatch queue on which to call `block`.
+ *  @param block      The block to call when the key path observation is triggered, is passed the observation (same as
+ *                    the method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOKVOObservation *)observeChangesToKeyPath:(NSString *)keyPath distinct:(TODistinctComparison)comparison onGCDQueue:(dispatch_queue_t)queue withBlock:(TOAnonymousObservationBlock)block;
+
 
 /**
  *  Stop observing a KVO key path on the receiver.
@@ -456,6 +548,39 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (TO_nullable TOKVOObservation *)observeChangesToKeyPaths:(NSArray *)keyPaths options:(int)options onGCDQueue:(dispatch_queue_t)queue withBlock:(TOAnonymousObservationBlock)block;
 
+/**
+ *  Observe multiple KVO key paths on the receiver, dropping changes that leave the value the same.
+ *
+ *  Variation on `observeChangesToKeyPaths:withBlock:` that adds a `distinctUntilChanged` parameter, comparing each
+ *  change's old and new values on the triggering thread. See the description for that method, and for
+ *  `distinctUntilChanged`. A `distinctComparator` can be set on the result to compare values some other way.
+ *
+ *  @param keyPaths   The array of KVO key path strings to observe on the receiver.
+ *  @param comparison How to tell that a change left the value the same.
+ *  @param block      The block to call when the key path observation is triggered, is passed the observation (same as
+ *                    the method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOKVOObservation *)observeChangesToKeyPaths:(NSArray *)keyPaths distinct:(TODistinctComparison)comparison withBlock:(TOAnonymousObservationBlock)block;
+
+/**
+ *  Observe multiple KVO key paths on the receiver, dropping changes that leave the value the same, calling its block on
+ *  the given GCD dispatch queue.
+ *
+ *  Variation on `observeChangesToKeyPaths:distinct:withBlock:` that adds a GCD dispatch queue parameter. Unchanged
+ *  values are dropped before anything is dispatched to the queue. See the description for that method.
+ *
+ *  @param keyPaths   The array of KVO key path strings to observe on the receiver.
+ *  @param comparison How to tell that a change left the value the same.
+ *  @param queue      The GCD dispatch queue on which to call `block`.
+ *  @param block      The block to call when the key path observation is triggered, is passed the observation (same as
+ *                    the method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOKVOObservation *)observeChangesToKeyPaths:(NSArray *)keyPaths distinct:(TODistinctComparison)comparison onGCDQueue:(dispatch_queue_t)queue withBlock:(TOAnonymousObservationBlock)block;
+
 
 /**
  *  Receiver stops observing the KVO key paths on the receiver.
@@ -472,6 +597,102 @@ NS_ASSUME_NONNULL_BEGIN
 - (BOOL)stopObservingChangesToKeyPaths:(NSArray *)keyPaths;
 
 
+#pragma mark - Anonymously observe a numeric key on the receiver
+
+/**
+ *  Observe a numeric key on the receiver, with its old and new values passed to the block as `double`.
+ *
+ *  Unlike other KVO observations, the value is read by calling the key's getter directly rather than from a change
+ *  dictionary, and a change that leaves the value equal to what it was before is dropped without calling the block.
+ *  See `TOKVOScalarObservation`.
+ *
+ *  The observation will automatically be stopped when the receiver is deallocated. The observation is not tied to any
+ *  "observer" object.
+ *
+ *  @param key   The key to observe on the receiver, which must have a getter returning a number type or `BOOL`.
+ *  @param block The block to call when the value changes, is passed the observation (same as the method result) and
+ *               the old and new values.
+ *
+ *  @return An observation object, or `nil` if the receiver has no getter for `key` returning a number type or `BOOL`.
+ */
+- (TO_nullable TOKVOObservation *)observeDoubleChangesToKeyPath:(NSString *)key withBlock:(TODoubleObservationBlock)block;
+
+/**
+ *  Observe a numeric key on the receiver, with its old and new values passed to the block as `double`, calling its
+ *  block on the given GCD dispatch queue.
+ *
+ *  Variation on `observeDoubleChangesToKeyPath:withBlock:` that adds a GCD dispatch queue parameter. See the
+ *  description for that method.
+ *
+ *  @param key   The key to observe on the receiver, which must have a getter returning a number type or `BOOL`.
+ *  @param queue The GCD dispatch queue on which to call `block`.
+ *  @param block The block to call when the value changes, is passed the observation (same as the method result) and
+ *               the old and new values.
+ *
+ *  @return An observation object, or `nil` if the receiver has no getter for `key` returning a number type or `BOOL`.
+ */
+- (TO_nullable TOKVOObservation *)observeDoubleChangesToKeyPath:(NSString *)key onGCDQueue:(dispatch_queue_t)queue withBlock:(TODoubleObservationBlock)block;
+
+/**
+ *  Observe a numeric key on the receiver, with its old and new values passed to the block as `NSInteger`.
+ *
+ *  Variation on `observeDoubleChangesToKeyPath:withBlock:` for an integer value. See the description for that
+ *  method.
+ *
+ *  @param key   The key to observe on the receiver, which must have a getter returning a number type or `BOOL`.
+ *  @param block The block to call when the value changes, is passed the observation (same as the method result) and
+ *               the old and new values.
+ *
+ *  @return An observation object, or `nil` if the receiver has no getter for `key` returning a number type or `BOOL`.
+ */
+- (TO_nullable TOKVOObservation *)observeIntegerChangesToKeyPath:(NSString *)key withBlock:(TOIntegerObservationBlock)block;
+
+/**
+ *  Observe a numeric key on the receiver, with its old and new values passed to the block as `NSInteger`, calling its
+ *  block on the given GCD dispatch queue.
+ *
+ *  Variation on `observeIntegerChangesToKeyPath:withBlock:` that adds a GCD dispatch queue parameter. See the
+ *  description for that method.
+ *
+ *  @param key   The key to observe on the receiver, which must have a getter returning a number type or `BOOL`.
+ *  @param queue The GCD dispatch queue on which to call `block`.
+ *  @param block The block to call when the value changes, is passed the observation (same as the method result) and
+ *               the old and new values.
+ *
+ *  @return An observation object, or `nil` if the receiver has no getter for `key` returning a number type or `BOOL`.
+ */
+- (TO_nullable TOKVOObservation *)observeIntegerChangesToKeyPath:(NSString *)key onGCDQueue:(dispatch_queue_t)queue withBlock:(TOIntegerObservationBlock)block;
+
+/**
+ *  Observe a numeric key on the receiver, with its old and new values passed to the block as `BOOL`.
+ *
+ *  Variation on `observeDoubleChangesToKeyPath:withBlock:` for a `BOOL` value. See the description for that method.
+ *
+ *  @param key   The key to observe on the receiver, which must have a getter returning a number type or `BOOL`.
+ *  @param block The block to call when the value changes, is passed the observation (same as the method result) and
+ *               the old and new values.
+ *
+ *  @return An observation object, or `nil` if the receiver has no getter for `key` returning a number type or `BOOL`.
+ */
+- (TO_nullable TOKVOObservation *)observeBoolChangesToKeyPath:(NSString *)key withBlock:(TOBoolObservationBlock)block;
+
+/**
+ *  Observe a numeric key on the receiver, with its old and new values passed to the block as `BOOL`, calling its
+ *  block on the given GCD dispatch queue.
+ *
+ *  Variation on `observeBoolChangesToKeyPath:withBlock:` that adds a GCD dispatch queue parameter. See the
+ *  description for that method.
+ *
+ *  @param key   The key to observe on the receiver, which must have a getter returning a number type or `BOOL`.
+ *  @param queue The GCD dispatch queue on which to call `block`.
+ *  @param block The block to call when the value changes, is passed the observation (same as the method result) and
+ *               the old and new values.
+ *
+ *  @return An observation object, or `nil` if the receiver has no getter for `key` returning a number type or `BOOL`.
+ */
+- (TO_nullable TOKVOObservation *)observeBoolChangesToKeyPath:(NSString *)key onGCDQueue:(dispatch_queue_t)queue withBlock:(TOBoolObservationBlock)block;
+
+
 #pragma mark - Have receiver observe a key path on itself
 
 /**
@@ -565,6 +786,60 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (TO_nullable TOKVOObservation *)observeOwnChangesToKeyPath:(NSString *)keyPath options:(int)options onGCDQueue:(dispatch_queue_t)queue withBlock:(TOObservationBlock)block;
 
+/**
+ *  Receiver observes a KVO key path on itself with options, calling its batch block on the given operation queue with
+ *  all the changes that occur while waiting for that queue.
+ *
+ *  Variation on `observeOwnChangesToKeyPath:options:onQueue:withBlock:` whose block is passed an array of
+ *  observations, one for each change in the order they occurred, instead of being called once per change. See the
+ *  description for that method, and the `batchBlock` property of `TOObservation`.
+ *
+ *  @param keyPath The key path string to observe on the receiver.
+ *  @param options The KVO observation options.
+ *  @param queue   The operation queue on which to call `block`.
+ *  @param block   The block to call with each batch, is passed the receiver (which can be used in place of a weakly
+ *                 captured self), and an array of observation copies each describing one change.
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOKVOObservation *)observeOwnChangesToKeyPath:(NSString *)keyPath options:(int)options onQueue:(NSOperationQueue *)queue withBatchBlock:(TOCollatedObservationBlock)block;
+
+/**
+ *  Receiver observes a KVO key path on itself with options, calling its batch block on the given GCD dispatch queue
+ *  with all the changes that occur while waiting for that queue.
+ *
+ *  Variation on `observeOwnChangesToKeyPath:options:onGCDQueue:withBlock:` whose block is passed an array of
+ *  observations, one for each change in the order they occurred, instead of being called once per change. See the
+ *  description for that method, and the `batchBlock` property of `TOObservation`.
+ *
+ *  @param keyPath The key path string to observe on the receiver.
+ *  @param options The KVO observation options.
+ *  @param queue   The GCD dispatch queue on which to call `block`.
+ *  @param block   The block to call with each batch, is passed the receiver (which can be used in place of a weakly
+ *                 captured self), and an array of observation copies each describing one change.
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOKVOObservation *)observeOwnChangesToKeyPath:(NSString *)keyPath options:(int)options onGCDQueue:(dispatch_queue_t)queue withBatchBlock:(TOCollatedObservationBlock)block;
+
+/**
+ *  Receiver observes one of its own KVO key paths, calling its block on the given GCD dispatch queue at a limited rate.
+ *
+ *  Variation on `observeOwnChangesToKeyPath:onGCDQueue:withBlock:` that limits how often its block is called,
+ *  applying `rateLimit` and `interval` to changes before they're passed to the queue. See the description for that
+ *  method, and the `rateLimit` property of `TOObservation`.
+ *
+ *  @param keyPath   The key path string to observe on the receiver.
+ *  @param queue     The GCD dispatch queue on which to call `block`.
+ *  @param rateLimit How to limit the rate of calls to `block`.
+ *  @param interval  The interval used by `rateLimit`.
+ *  @param block     The block to call when the observation is triggered, is passed the receiver (which can be used
+ *                   in place of a weakly captured self), and the observation (same as method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TOKVOObservation *)observeOwnChangesToKeyPath:(NSString *)keyPath onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block;
+
 
 /**
  *  Receiver stops observing a KVO key path on itself.
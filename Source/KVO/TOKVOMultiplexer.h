@@ -0,0 +1,89 @@
+//
+//  TOKVOMultiplexer.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+//  Shares KVO registrations among all of the KVO observations of one object. Each distinct key path is registered
+//  with KVO once, with the union of the options its observations asked for, and each change is fanned out to those
+//  observations from an immutable array that's replaced whenever one is added or removed. So observing a key path
+//  already observed, or removing an observation that isn't its last, does no KVO work at all.
+//
+//  Since the registration is shared, its options can include more than an observation asked for. Prior notifications
+//  are only passed to observations asking for them, and `NSKeyValueObservingOptionInitial` is handled separately for
+//  each observation, but change dictionaries can have old and new values an observation didn't ask for.
+//
+//  When `TOKVONativeEngine` can prepare the object for a key, that key isn't registered with KVO at all, and instead
+//  the engine's overridden setter fetches the key's observations and passes them each change. Those keys are
+//  registered with KVO after all once anything, including the multiplexer itself, adds KVO to the object.
+//
+//  Attached to the observed object as an associated object, and also kept by each of its registered observations.
+
+#import <Foundation/Foundation.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#define TO_nullable nullable
+#else
+#define TO_nullable
+#endif
+
+@class TOKVOObservation;
+
+@interface TOKVOMultiplexer : NSObject
+
+/**
+ *  The multiplexer attached to the given object, attaching a new one if there's none yet.
+ */
++ (instancetype)multiplexerForObject:(id)object;
+
+/**
+ *  The multiplexer attached to the given object, or nil if there's none yet. Doesn't lock, for the native engine's
+ *  setters which are called for every change.
+ */
++ (TO_nullable instancetype)existingMultiplexerForObject:(id)object;
+
+/**
+ *  Fan out changes to the key path to the observation, registering the key path with KVO if it's the first
+ *  observation of it, or registering it again if the observation asks for options the registration doesn't have. An
+ *  observation asking for `NSKeyValueObservingOptionInitial` is passed its initial change before this returns, with
+ *  a new value only if its own `options` include `NSKeyValueObservingOptionNew`.
+ *
+ *  @param observation The observation, which is passed each change by `observeChange:forKeyPath:`.
+ *  @param keyPath     The key path to observe.
+ *  @param options     The options to register with, the observation's own plus any it needs internally.
+ */
+- (void)addObservation:(TOKVOObservation *)observation forKeyPath:(NSString *)keyPath options:(NSKeyValueObservingOptions)options;
+
+/**
+ *  Stop fanning out changes to the key path to the observation, deregistering the key path from KVO if it was the
+ *  last observation of it.
+ *
+ *  @param observation The observation added before.
+ *  @param keyPath     The key path it was added for.
+ */
+- (void)removeObservation:(TOKVOObservation *)observation forKeyPath:(NSString *)keyPath;
+
+/**
+ *  The observations to pass a change to the key, if the key is observed through the native engine rather than KVO.
+ *
+ *  @param key        The key, observed as a key path.
+ *  @param optionsOut Set to the options of the key's registration, which are the union of its observations' options.
+ *
+ *  @return An immutable array of the key's observations, or nil if it isn't observed natively.
+ */
+- (TO_nullable NSArray *)nativeObservationsForKey:(NSString *)key options:(NSKeyValueObservingOptions *)optionsOut;
+
+/**
+ *  Register every key observed through the native engine with KVO instead, changing the object back to its original
+ *  class first. Called by the engine's subclass before KVO is added to the object.
+ */
+- (void)moveNativeRegistrationsToKeyValueObserving;
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
+#undef TO_nullable
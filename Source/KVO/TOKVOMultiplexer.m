@@ -0,0 +1,262 @@
+//
+//  TOKVOMultiplexer.m
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOKVOMultiplexer.h"
+#import "TOKVONativeEngine.h"
+#import "TOKVOObservation+Private.h"
+#import "TOStripedLock.h"
+#import <objc/runtime.h>
+#import <pthread.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#else
+#define nullable
+#endif
+
+static const int TOKVOMultiplexerKeyVar;
+static void *TOKVOMultiplexerKey = (void *)&TOKVOMultiplexerKeyVar;
+
+/**
+ *  One key path's registration with KVO, whose address is also the registration's context. Replaced by a new
+ *  registration rather than changed when more options are needed. A native registration isn't registered with KVO at
+ *  all, and has its options changed in place.
+ */
+@interface TOKVOKeyPathRegistration : NSObject {
+  @package
+    BOOL _native;
+    NSKeyValueObservingOptions _options; // only changed in place with the multiplexer's _mutex held
+    NSArray *_observations; // replaced rather than mutated, guarded by the multiplexer's _mutex
+}
+@end
+
+@implementation TOKVOKeyPathRegistration
+@end
+
+
+@implementation TOKVOMultiplexer {
+    __weak id _object;
+    pthread_mutex_t _registrationMutex;  // serializes adding and removing, held while calling KVO
+    pthread_mutex_t _mutex;              // guards _registrations, never held while calling out
+    NSMutableDictionary *_registrations; // each key path's current TOKVOKeyPathRegistration
+}
+
++ (instancetype)multiplexerForObject:(id)object
+{
+    const void *lockAddress = (__bridge const void *)object;
+    TOStripedLockLock(lockAddress);
+    
+    TOKVOMultiplexer *multiplexer = objc_getAssociatedObject(object, TOKVOMultiplexerKey);
+    if (multiplexer == nil) {
+        multiplexer = [[self alloc] initWithObject:object];
+        objc_setAssociatedObject(object, TOKVOMultiplexerKey, multiplexer, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    
+    TOStripedLockUnlock(lockAddress);
+    
+    return multiplexer;
+}
+
++ (nullable instancetype)existingMultiplexerForObject:(id)object
+{
+    return objc_getAssociatedObject(object, TOKVOMultiplexerKey);
+}
+
+- (instancetype)initWithObject:(id)object
+{
+    if (!(self = [super init]))
+        return nil;
+    _object = object;
+    pthread_mutex_init(&_registrationMutex, NULL);
+    pthread_mutex_init(&_mutex, NULL);
+    _registrations = [NSMutableDictionary dictionary];
+    return self;
+}
+
+- (void)dealloc
+{
+    // only once no registered observation keeps it, so nothing is still registered with KVO
+    pthread_mutex_destroy(&_registrationMutex);
+    pthread_mutex_destroy(&_mutex);
+}
+
+- (void)addObservation:(TOKVOObservation *)observation forKeyPath:(NSString *)keyPath options:(NSKeyValueObservingOptions)options
+{
+    NSKeyValueObservingOptions sharedOptions = options & ~NSKeyValueObservingOptionInitial;
+    id object = _object;
+    
+    pthread_mutex_lock(&_registrationMutex);
+    
+    // only changed with _registrationMutex held, so it's safe to keep using it outside _mutex
+    pthread_mutex_lock(&_mutex);
+    TOKVOKeyPathRegistration *registration = _registrations[keyPath];
+    pthread_mutex_unlock(&_mutex);
+    
+    if (registration == nil && [TOKVONativeEngine prepareObject:object forKey:keyPath]) {
+        // changes come from the native engine's setter instead, no KVO work
+        TOKVOKeyPathRegistration *nativeRegistration = [[TOKVOKeyPathRegistration alloc] init];
+        nativeRegistration->_native = YES;
+        nativeRegistration->_options = sharedOptions;
+        nativeRegistration->_observations = @[observation];
+        pthread_mutex_lock(&_mutex);
+        _registrations[keyPath] = nativeRegistration;
+        pthread_mutex_unlock(&_mutex);
+    }
+    else if (registration != nil && (registration->_native || (registration->_options & sharedOptions) == sharedOptions)) {
+        // already registered with every option needed, or a native registration, no KVO work
+        NSArray *observations NS_VALID_UNTIL_END_OF_SCOPE = registration->_observations;
+        NSArray *replacementObservations = [observations arrayByAddingObject:observation];
+        pthread_mutex_lock(&_mutex);
+        registration->_options |= sharedOptions;
+        registration->_observations = replacementObservations;
+        pthread_mutex_unlock(&_mutex);
+    }
+    else {
+        [self moveNativeRegistrationsToKeyValueObservingLocked:object]; // must happen before KVO subclasses it
+        
+        TOKVOKeyPathRegistration *replacement = [[TOKVOKeyPathRegistration alloc] init];
+        replacement->_options = (registration != nil ? registration->_options : 0) | sharedOptions;
+        replacement->_observations = registration != nil ? [registration->_observations arrayByAddingObject:observation] : @[observation];
+        
+        // registered before it replaces the old one, so no change goes unseen, and observeValueForKeyPath: only
+        // passes on changes through whichever is current, so until the swap the old one covers what this one drops
+        [object addObserver:self forKeyPath:keyPath options:replacement->_options context:(__bridge void *)replacement];
+        pthread_mutex_lock(&_mutex);
+        _registrations[keyPath] = replacement;
+        pthread_mutex_unlock(&_mutex);
+        if (registration != nil)
+            [object removeObserver:self forKeyPath:keyPath context:(__bridge void *)registration];
+    }
+    
+    pthread_mutex_unlock(&_registrationMutex);
+    
+    if (options & NSKeyValueObservingOptionInitial) {
+        // just for this observation, as KVO would if it were registering it separately, and with only the values it
+        // asked for rather than any that `options` adds for its own use, such as for distinctUntilChanged
+        NSDictionary *change;
+        if (observation.options & NSKeyValueObservingOptionNew)
+            change = @{ NSKeyValueChangeKindKey: @(NSKeyValueChangeSetting), NSKeyValueChangeNewKey: [object valueForKeyPath:keyPath] ?: [NSNull null] };
+        else
+            change = @{ NSKeyValueChangeKindKey: @(NSKeyValueChangeSetting) };
+        [observation observeChange:change forKeyPath:keyPath];
+    }
+}
+
+- (void)removeObservation:(TOKVOObservation *)observation forKeyPath:(NSString *)keyPath
+{
+    id object = _object;
+    
+    pthread_mutex_lock(&_registrationMutex);
+    
+    pthread_mutex_lock(&_mutex);
+    TOKVOKeyPathRegistration *registration NS_VALID_UNTIL_END_OF_SCOPE = _registrations[keyPath];
+    pthread_mutex_unlock(&_mutex);
+    
+    NSUInteger index = registration != nil ? [registration->_observations indexOfObjectIdenticalTo:observation] : NSNotFound;
+    if (index != NSNotFound) {
+        NSArray *observations NS_VALID_UNTIL_END_OF_SCOPE = registration->_observations;
+        if (observations.count > 1) {
+            // others still observing, no KVO work
+            NSMutableArray *replacementObservations = [observations mutableCopy];
+            [replacementObservations removeObjectAtIndex:index];
+            pthread_mutex_lock(&_mutex);
+            registration->_observations = [replacementObservations copy];
+            pthread_mutex_unlock(&_mutex);
+        }
+        else {
+            pthread_mutex_lock(&_mutex);
+            [_registrations removeObjectForKey:keyPath];
+            BOOL stillObservedNatively = registration->_native && [self hasNativeRegistrationLocked];
+            pthread_mutex_unlock(&_mutex);
+            if (!registration->_native)
+                [object removeObserver:self forKeyPath:keyPath context:(__bridge void *)registration];
+            else if (!stillObservedNatively)
+                [TOKVONativeEngine restoreObject:object]; // the overridden setters are no longer needed
+        }
+    }
+    
+    pthread_mutex_unlock(&_registrationMutex);
+}
+
+// called with _mutex held
+- (BOOL)hasNativeRegistrationLocked
+{
+    for (TOKVOKeyPathRegistration *registration in _registrations.objectEnumerator) {
+        if (registration->_native)
+            return YES;
+    }
+    return NO;
+}
+
+- (void)moveNativeRegistrationsToKeyValueObserving
+{
+    id object = _object;
+    pthread_mutex_lock(&_registrationMutex);
+    [self moveNativeRegistrationsToKeyValueObservingLocked:object];
+    pthread_mutex_unlock(&_registrationMutex);
+}
+
+// called with _registrationMutex held
+- (void)moveNativeRegistrationsToKeyValueObservingLocked:(nullable id)object
+{
+    pthread_mutex_lock(&_mutex);
+    NSDictionary *registrations = [self hasNativeRegistrationLocked] ? [_registrations copy] : nil;
+    pthread_mutex_unlock(&_mutex);
+    if (registrations == nil || object == nil)
+        return;
+    
+    // back to the original class first, so KVO subclasses that, a change made in between is missed
+    [TOKVONativeEngine restoreObject:object];
+    [registrations enumerateKeysAndObjectsUsingBlock:^(NSString *keyPath, TOKVOKeyPathRegistration *registration, BOOL *stop) {
+        if (!registration->_native)
+            return;
+        TOKVOKeyPathRegistration *replacement = [[TOKVOKeyPathRegistration alloc] init];
+        pthread_mutex_lock(&self->_mutex);
+        replacement->_options = registration->_options;
+        replacement->_observations = registration->_observations;
+        pthread_mutex_unlock(&self->_mutex);
+        
+        [object addObserver:self forKeyPath:keyPath options:replacement->_options context:(__bridge void *)replacement];
+        pthread_mutex_lock(&self->_mutex);
+        self->_registrations[keyPath] = replacement;
+        pthread_mutex_unlock(&self->_mutex);
+    }];
+}
+
+- (nullable NSArray *)nativeObservationsForKey:(NSString *)key options:(NSKeyValueObservingOptions *)optionsOut
+{
+    pthread_mutex_lock(&_mutex);
+    TOKVOKeyPathRegistration *registration = _registrations[key];
+    NSArray *observations = registration != nil && registration->_native ? registration->_observations : nil;
+    *optionsOut = registration != nil ? registration->_options : 0;
+    pthread_mutex_unlock(&_mutex);
+    return observations;
+}
+
+- (void)observeValueForKeyPath:(nullable NSString *)keyPath ofObject:(nullable id)object change:(nullable NSDictionary *)change context:(nullable void *)context
+{
+    pthread_mutex_lock(&_mutex);
+    TOKVOKeyPathRegistration *registration = keyPath != nil ? _registrations[keyPath] : nil;
+    // a registration being replaced may still see changes, only those through the current one are passed on
+    NSArray *observations = (__bridge void *)registration == context ? registration->_observations : nil;
+    pthread_mutex_unlock(&_mutex);
+    
+    BOOL prior = [(NSNumber *)change[NSKeyValueChangeNotificationIsPriorKey] boolValue];
+    for (TOKVOObservation *observation in observations) {
+        if (!prior || (observation.options & NSKeyValueObservingOptionPrior) != 0)
+            [observation observeChange:change forKeyPath:(NSString *)keyPath];
+    }
+}
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#else
+#undef nullable
+#endif
@@ -0,0 +1,63 @@
+//
+//  TOKVONativeEngine.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+//  TotalObserver's own engine for observing property changes, used instead of Foundation KVO for instances of classes
+//  it's enabled for. Like KVO, it changes an observed object's class to a subclass created at runtime, in which each
+//  observed property's setter is overridden. The override calls the original setter, reading the old and new values
+//  through the property's getter only if observations asked for them, and passes them to the object's observations
+//  through its `TOKVOMultiplexer`. No change dictionary is built.
+//
+//  Only simple keys, rather than key paths, whose setter and getter take and return an object or a number are
+//  supported, and only changes made by calling the setter are seen. Objects already given a subclass by KVO or
+//  anything else are left alone. In all those cases observations fall back to Foundation KVO.
+//
+//  An object goes back to its original class once its last native observation is removed, so it no longer pays for
+//  the overridden setters. It also goes back before anything adds KVO to it, with its native observations moving to
+//  KVO, since KVO would otherwise subclass the engine's subclass and report it from `-class`.
+
+#import <Foundation/Foundation.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#define TO_nullable nullable
+#else
+#define TO_nullable
+#endif
+
+@interface TOKVONativeEngine : NSObject
+
+/**
+ *  Whether the engine is used for instances of the class, having been enabled for it or one of its superclasses.
+ */
++ (BOOL)isEnabledForClass:(Class)cls;
+
+/**
+ *  Enable or disable the engine for instances of the class and its subclasses. Doesn't affect objects already
+ *  observed.
+ */
++ (void)setEnabled:(BOOL)enabled forClass:(Class)cls;
+
+/**
+ *  If the engine is enabled for the object's class and supports the key, make sure the object's class is the engine's
+ *  subclass for it, with the key's setter overridden.
+ *
+ *  @return `YES` if changes to the key will be passed to the object's multiplexer, `NO` if it's to use KVO instead.
+ */
++ (BOOL)prepareObject:(id)object forKey:(NSString *)key;
+
+/**
+ *  Change the object's class back from the engine's subclass to its original class, if it's still the engine's
+ *  subclass. Called once nothing observes the object natively any longer, or before KVO is added to it.
+ */
++ (void)restoreObject:(TO_nullable id)object;
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
+#undef TO_nullable
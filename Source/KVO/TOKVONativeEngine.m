@@ -0,0 +1,256 @@
+//
+//  TOKVONativeEngine.m
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOKVONativeEngine.h"
+#import "TOKVOMultiplexer.h"
+#import "TOKVOObservation+Private.h"
+#import <objc/runtime.h>
+#import <pthread.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#else
+#define nullable
+#endif
+
+static NSString * const TONativeSubclassPrefix = @"TONativeObserving_";
+
+static pthread_mutex_t nativeEngineMutex = PTHREAD_MUTEX_INITIALIZER;
+static NSMutableSet *enabledClasses;       // guarded by nativeEngineMutex, as are the following
+static NSMapTable *nativeSubclasses;       // original class to its subclass
+static NSMapTable *overriddenKeysBySubclass; // subclass to the set of keys whose setters it overrides
+
+static void TONotifyNativeChange(NSArray *observations, NSString *key, id _Nullable oldValue, id _Nullable newValue, BOOL prior)
+{
+    for (TOKVOObservation *observation in observations) {
+        if (!prior || (observation.options & NSKeyValueObservingOptionPrior) != 0)
+            [observation observeNativeChangeToKeyPath:key oldValue:oldValue newValue:newValue prior:prior];
+    }
+}
+
+// values are boxed as KVO would put them in a change dictionary, only when an observation asked for them
+#define TO_BOX_OBJECT(value) ((value) ?: (id)[NSNull null])
+#define TO_BOX_NUMBER(value) @(value)
+
+// the original setter and getter are looked up on each call, through the runtime's method cache, so that methods
+// swizzled or added to the original class after the subclass overrode the setter are still called
+#define TO_NATIVE_SETTER(type, box) imp_implementationWithBlock(^(id object, type value) { \
+    IMP setter = class_getMethodImplementation(cls, setterSelector); \
+    NSKeyValueObservingOptions options = 0; \
+    NSArray *observations = [[TOKVOMultiplexer existingMultiplexerForObject:object] nativeObservationsForKey:key options:&options]; \
+    if (observations == nil) { \
+        ((void (*)(id, SEL, type))setter)(object, setterSelector, value); \
+        return; \
+    } \
+    IMP getter = class_getMethodImplementation(cls, getterSelector); \
+    id oldValue = nil; \
+    if ((options & NSKeyValueObservingOptionOld) != 0) { \
+        type previous = ((type (*)(id, SEL))getter)(object, getterSelector); \
+        oldValue = box(previous); \
+    } \
+    if ((options & NSKeyValueObservingOptionPrior) != 0) \
+        TONotifyNativeChange(observations, key, oldValue, nil, YES); \
+    ((void (*)(id, SEL, type))setter)(object, setterSelector, value); \
+    id newValue = nil; \
+    if ((options & NSKeyValueObservingOptionNew) != 0) { \
+        type current = ((type (*)(id, SEL))getter)(object, getterSelector); \
+        newValue = box(current); \
+    } \
+    TONotifyNativeChange(observations, key, oldValue, newValue, NO); \
+})
+
+static const char *TOSkipTypeQualifiers(const char *type)
+{
+    while (*type != '\0' && strchr("rnNoORV", *type) != NULL) {
+        ++type;
+    }
+    return type;
+}
+
+// the override for the key's setter, or NULL if the class doesn't have a setter and getter of a supported type
+static IMP _Nullable TONativeSetterForKey(Class cls, NSString *key, SEL *selectorOut, const char *_Nullable *_Nonnull typesOut)
+{
+    NSString *capitalizedKey = [[key substringToIndex:1].uppercaseString stringByAppendingString:[key substringFromIndex:1]];
+    SEL setterSelector = NSSelectorFromString([NSString stringWithFormat:@"set%@:", capitalizedKey]);
+    Method setterMethod = class_getInstanceMethod(cls, setterSelector);
+    if (setterMethod == NULL || method_getNumberOfArguments(setterMethod) != 3)
+        return NULL;
+    SEL getterSelector = NSSelectorFromString(key);
+    Method getterMethod = class_getInstanceMethod(cls, getterSelector);
+    if (getterMethod == NULL) {
+        getterSelector = NSSelectorFromString([@"is" stringByAppendingString:capitalizedKey]);
+        getterMethod = class_getInstanceMethod(cls, getterSelector);
+    }
+    if (getterMethod == NULL || method_getNumberOfArguments(getterMethod) != 2)
+        return NULL;
+    
+    char argumentType[64];
+    char returnType[64];
+    method_getArgumentType(setterMethod, 2, argumentType, sizeof(argumentType));
+    method_getReturnType(getterMethod, returnType, sizeof(returnType));
+    const char *type = TOSkipTypeQualifiers(argumentType);
+    if (strcmp(type, TOSkipTypeQualifiers(returnType)) != 0 || strlen(type) != 1)
+        return NULL; // also rules out structs, pointers and such
+    
+    *selectorOut = setterSelector;
+    *typesOut = method_getTypeEncoding(setterMethod);
+    switch (type[0]) {
+        case '@': return TO_NATIVE_SETTER(id, TO_BOX_OBJECT);
+        case 'c': return TO_NATIVE_SETTER(char, TO_BOX_NUMBER);
+        case 'B': return TO_NATIVE_SETTER(bool, TO_BOX_NUMBER);
+        case 's': return TO_NATIVE_SETTER(short, TO_BOX_NUMBER);
+        case 'i': return TO_NATIVE_SETTER(int, TO_BOX_NUMBER);
+        case 'l': return TO_NATIVE_SETTER(long, TO_BOX_NUMBER);
+        case 'q': return TO_NATIVE_SETTER(long long, TO_BOX_NUMBER);
+        case 'C': return TO_NATIVE_SETTER(unsigned char, TO_BOX_NUMBER);
+        case 'S': return TO_NATIVE_SETTER(unsigned short, TO_BOX_NUMBER);
+        case 'I': return TO_NATIVE_SETTER(unsigned int, TO_BOX_NUMBER);
+        case 'L': return TO_NATIVE_SETTER(unsigned long, TO_BOX_NUMBER);
+        case 'Q': return TO_NATIVE_SETTER(unsigned long long, TO_BOX_NUMBER);
+        case 'f': return TO_NATIVE_SETTER(float, TO_BOX_NUMBER);
+        case 'd': return TO_NATIVE_SETTER(double, TO_BOX_NUMBER);
+        default: return NULL;
+    }
+}
+
+// called with nativeEngineMutex held
+static Class _Nullable TONativeSubclassForClass(Class cls)
+{
+    Class subclass = [nativeSubclasses objectForKey:cls];
+    if (subclass != nil)
+        return subclass;
+    
+    NSString *name = [TONativeSubclassPrefix stringByAppendingString:NSStringFromClass(cls)];
+    subclass = objc_allocateClassPair(cls, name.UTF8String, 0);
+    if (subclass == nil)
+        return nil;
+    // hidden from -class, as KVO does with its subclasses
+    IMP classImp = imp_implementationWithBlock(^Class(id object) {
+        return cls;
+    });
+    class_addMethod(subclass, @selector(class), classImp, method_getTypeEncoding(class_getInstanceMethod(cls, @selector(class))));
+    
+    // KVO would subclass this subclass and report it from its own -class, so before anything adds KVO the object
+    // goes back to its original class and its native observations move to KVO
+    SEL addObserverSelector = @selector(addObserver:forKeyPath:options:context:);
+    IMP addObserverImp = imp_implementationWithBlock(^(id object, NSObject *observer, NSString *keyPath, NSKeyValueObservingOptions options, void *_Nullable context) {
+        [[TOKVOMultiplexer existingMultiplexerForObject:object] moveNativeRegistrationsToKeyValueObserving];
+        [TOKVONativeEngine restoreObject:object];
+        IMP original = class_getMethodImplementation(cls, addObserverSelector);
+        ((void (*)(id, SEL, NSObject *, NSString *, NSKeyValueObservingOptions, void *))original)(object, addObserverSelector, observer, keyPath, options, context);
+    });
+    class_addMethod(subclass, addObserverSelector, addObserverImp, method_getTypeEncoding(class_getInstanceMethod(cls, addObserverSelector)));
+    objc_registerClassPair(subclass);
+    
+    [nativeSubclasses setObject:subclass forKey:cls];
+    [overriddenKeysBySubclass setObject:[NSMutableSet set] forKey:subclass];
+    return subclass;
+}
+
+
+@implementation TOKVONativeEngine
+
++ (void)initialize
+{
+    if (self != [TOKVONativeEngine class])
+        return;
+    enabledClasses = [NSMutableSet set];
+    NSPointerFunctionsOptions classOptions = NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality;
+    nativeSubclasses = [[NSMapTable alloc] initWithKeyOptions:classOptions valueOptions:classOptions capacity:0];
+    overriddenKeysBySubclass = [[NSMapTable alloc] initWithKeyOptions:classOptions valueOptions:NSPointerFunctionsStrongMemory capacity:0];
+}
+
++ (BOOL)isEnabledForClassLocked:(Class)cls
+{
+    for (Class c = cls; c != nil; c = class_getSuperclass(c)) {
+        if ([enabledClasses containsObject:c])
+            return YES;
+    }
+    return NO;
+}
+
++ (BOOL)isEnabledForClass:(Class)cls
+{
+    pthread_mutex_lock(&nativeEngineMutex);
+    BOOL enabled = [self isEnabledForClassLocked:cls];
+    pthread_mutex_unlock(&nativeEngineMutex);
+    return enabled;
+}
+
++ (void)setEnabled:(BOOL)enabled forClass:(Class)cls
+{
+    pthread_mutex_lock(&nativeEngineMutex);
+    if (enabled)
+        [enabledClasses addObject:cls];
+    else
+        [enabledClasses removeObject:cls];
+    pthread_mutex_unlock(&nativeEngineMutex);
+}
+
++ (BOOL)prepareObject:(id)object forKey:(NSString *)key
+{
+    if (key.length == 0 || [key hasPrefix:@"@"] || [key rangeOfString:@"."].location != NSNotFound)
+        return NO;
+    
+    BOOL prepared = NO;
+    Class cls = [object class];
+    
+    pthread_mutex_lock(&nativeEngineMutex);
+    
+    Class current = object_getClass(object);
+    // objects whose class was changed by anything else, such as KVO, are left to KVO
+    BOOL isOwnSubclass = [overriddenKeysBySubclass objectForKey:current] != nil && class_getSuperclass(current) == cls;
+    if ([self isEnabledForClassLocked:cls] && (current == cls || isOwnSubclass)) {
+        Class subclass = isOwnSubclass ? current : [nativeSubclasses objectForKey:cls];
+        NSMutableSet *overriddenKeys = subclass != nil ? [overriddenKeysBySubclass objectForKey:subclass] : nil;
+        if ([overriddenKeys containsObject:key]) {
+            prepared = YES;
+        }
+        else {
+            SEL setterSelector = NULL;
+            const char *types = NULL;
+            IMP setter = TONativeSetterForKey(cls, key, &setterSelector, &types);
+            if (setter != NULL && subclass == nil)
+                subclass = TONativeSubclassForClass(cls);
+            if (setter != NULL && subclass != nil) {
+                class_addMethod(subclass, setterSelector, setter, types);
+                [[overriddenKeysBySubclass objectForKey:subclass] addObject:key];
+                prepared = YES;
+            }
+            else if (setter != NULL) {
+                imp_removeBlock(setter);
+            }
+        }
+        if (prepared && current != subclass)
+            object_setClass(object, subclass);
+    }
+    
+    pthread_mutex_unlock(&nativeEngineMutex);
+    
+    return prepared;
+}
+
++ (void)restoreObject:(nullable id)object
+{
+    if (object == nil)
+        return;
+    
+    pthread_mutex_lock(&nativeEngineMutex);
+    Class current = object_getClass(object);
+    if ([overriddenKeysBySubclass objectForKey:current] != nil)
+        object_setClass(object, class_getSuperclass(current));
+    pthread_mutex_unlock(&nativeEngineMutex);
+}
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#else
+#undef nullable
+#endif
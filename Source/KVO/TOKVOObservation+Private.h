@@ -19,6 +19,16 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (instancetype)initWithObserver:(nullable id)observer object:(id)object keyPaths:(NSArray *)keyPaths options:(int)options queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue block:(TOObservationBlock)block;
 - (instancetype)initWithObject:(id)object keyPaths:(NSArray *)keyPaths options:(int)options queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue block:(TOAnonymousObservationBlock)block;
+- (instancetype)initWithObserver:(nullable id)observer object:(id)object keyPaths:(NSArray *)keyPaths options:(int)options queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue batchBlock:(nullable TOCollatedObservationBlock)block;
+
+// called by TOKVOMultiplexer with each change to one of the observed key paths
+- (void)observeChange:(TO_nullable NSDictionary *)change forKeyPath:(NSString *)keyPath;
+
+// sets the event's key path and change dictionary, its other properties are decoded from the dictionary when read
+- (void)takeChange:(TO_nullable NSDictionary *)change forKeyPath:(TO_nullable NSString *)keyPath;
+
+// called by TOKVONativeEngine's setters with each change to an observed key, with values only if asked for
+- (void)observeNativeChangeToKeyPath:(NSString *)keyPath oldValue:(TO_nullable id)oldValue newValue:(TO_nullable id)newValue prior:(BOOL)prior;
 
 // TODO: consider making this private too
 //+ (BOOL)removeForObserver:(TO_nullable id)observer object:(id)object keyPaths:(NSArray *)keyPaths;
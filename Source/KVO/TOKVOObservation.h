@@ -15,6 +15,34 @@ NS_ASSUME_NONNULL_BEGIN
 #define TO_nullable
 #endif
 
+/**
+ *  How a KVO observation decides that a change left its key path's value the same, see `distinctUntilChanged`.
+ */
+typedef NS_ENUM(NSInteger, TODistinctComparison) {
+    /**
+     *  Deliver every change. This is the default.
+     */
+    TODistinctComparisonNone = 0,
+    /**
+     *  Drop changes whose old and new values are the same object.
+     */
+    TODistinctComparisonIdentical,
+    /**
+     *  Drop changes whose old and new values are the same object or are equal by `isEqual:`.
+     */
+    TODistinctComparisonEqual
+};
+
+/**
+ *  A block deciding whether a change left a KVO observation's key path's value the same, see `distinctComparator`.
+ *
+ *  @param oldValue The value before the change, `NSNull` if it was `nil`.
+ *  @param newValue The value after the change, `NSNull` if it's `nil`.
+ *
+ *  @return `YES` if the values are the same, so the change is dropped.
+ */
+typedef BOOL (^TODistinctComparator)(id oldValue, id newValue);
+
 /**
  *  A base class for KVO observation objects.
  *
@@ -37,6 +65,28 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) NSKeyValueObservingOptions options;
 
+/**
+ *  How to tell that a change didn't actually change the value, for setters that are often called with the value
+ *  already set. (default is `TODistinctComparisonNone`)
+ *
+ *  Each change is compared on the triggering thread, and one that left the value the same is dropped before it's
+ *  given to `executor` or anything else is done with it. Applies to each key path separately. Initial and prior
+ *  changes, and changes to the contents of to-many relationships, are always delivered. Asks KVO for the old and new
+ *  values in addition to `options`, so must be set before the observation is registered, use the `distinct:`
+ *  variants of the `to_observeChangesToKeyPath:` methods.
+ *
+ *  Number properties are boxed afresh for each change, so use `TODistinctComparisonEqual` rather than
+ *  `TODistinctComparisonIdentical` for those.
+ */
+@property (nonatomic) TODistinctComparison distinctUntilChanged;
+
+/**
+ *  A block used to compare old and new values instead of the comparison chosen by `distinctUntilChanged`, which must
+ *  not be `TODistinctComparisonNone` for it to be used. Called on the triggering thread, so must be fast and safe to
+ *  call from any thread. Can be set at any time. (default is `nil`)
+ */
+@property (atomic, copy, TO_nullable) TODistinctComparator distinctComparator;
+
 
 /**
  *  Key path that triggered a KVO observation. Value undefined except within call to an observation block.
@@ -44,9 +94,11 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, readonly, copy) NSString *keyPath;
 
 /**
- *  Change dictionary for a KVO observation. Value undefined except within call to an observation block.
+ *  Change dictionary for a KVO observation. Value undefined except within call to an observation block. For a change
+ *  observed natively (see `setObservesNatively:instancesOfClass:`), built from the properties below when first asked
+ *  for.
  */
-@property (nonatomic, readonly) NSDictionary *changeDict;
+@property (nonatomic, readonly, TO_nullable) NSDictionary *changeDict;
 
 /**
  *  The kind of a KVO observation. Value undefined except within call to an observation block. A shortcut for
@@ -95,6 +147,35 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (BOOL)removeForObserver:(TO_nullable id)observer object:(id)object keyPaths:(NSArray *)keyPaths;
 
+/**
+ *  Whether KVO observations of instances of the class, or of a subclass, are made with TotalObserver's own native
+ *  engine rather than Foundation KVO where possible. Default is `NO` for every class.
+ *
+ *  @param cls The class of the observed objects.
+ *
+ *  @return `YES` if the class or one of its superclasses was set to be observed natively.
+ */
++ (BOOL)observesNativelyInstancesOfClass:(Class)cls;
+
+/**
+ *  Switch the native engine on or off for observations of instances of the class and its subclasses. Affects only
+ *  key paths first observed on an object afterwards.
+ *
+ *  Like KVO, the engine changes an observed object's class to a subclass generated at runtime, whose setters for the
+ *  observed keys call the original setter and then pass the change to the key's observations directly, fetching the
+ *  old and new values from the getter only if an observation asked for them, with no change dictionary or
+ *  `observeValueForKeyPath:ofObject:change:context:`. Only changes made through the setter are seen, not those made
+ *  to the instance variable directly and announced with `willChangeValueForKey:` and `didChangeValueForKey:`.
+ *
+ *  Key paths with more than one key, keys whose setter and getter aren't an object or a number type, and objects
+ *  already observed with Foundation KVO or whose class was changed some other way, are all observed with Foundation
+ *  KVO as before.
+ *
+ *  @param natively `YES` to observe natively, `NO` to go back to Foundation KVO.
+ *  @param cls      The class of the objects to observe.
+ */
++ (void)setObservesNatively:(BOOL)natively instancesOfClass:(Class)cls;
+
 @end
 
 #if __has_feature(nullability)
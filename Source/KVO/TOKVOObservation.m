@@ -9,6 +9,8 @@
 #import "TOKVOObservation.h"
 #import "TOKVOObservation+Private.h"
 #import "TOObservation+Private.h"
+#import "TOKVOMultiplexer.h"
+#import "TOKVONativeEngine.h"
 
 #if __has_feature(nullability)
 NS_ASSUME_NONNULL_BEGIN
@@ -21,19 +23,19 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, readwrite) NSKeyValueObservingOptions options;
 
 @property (nonatomic, readwrite, copy) NSString *keyPath;
-@property (nonatomic, readwrite) NSDictionary *changeDict;
-@property (nonatomic, readwrite) NSUInteger kind;
-@property (nonatomic, readwrite, getter=isPrior) BOOL prior;
-@property (nonatomic, readwrite, nullable) id changedValue;
-@property (nonatomic, readwrite, nullable) id oldValue;
-@property (nonatomic, readwrite, nullable) NSIndexSet *indexes;
-@end
+@property (nonatomic, readwrite, nullable) NSDictionary *changeDict; // nil for native changes until asked for
 
-static const int TOKVOObservationContextVar;
-static void *TOKVOObservationContext = (void *)&TOKVOObservationContextVar;
+@property (nonatomic, nullable) TOKVOMultiplexer *multiplexer; // while registered
+@end
 
 
-@implementation TOKVOObservation
+@implementation TOKVOObservation {
+    // a native change's values, which have no change dictionary, otherwise the properties decode it only when asked
+    BOOL _nativeChange;
+    BOOL _nativePrior;
+    id _nativeChangedValue;
+    id _nativeOldValue;
+}
 
 - (instancetype)initWithObserver:(nullable id)observer object:(id)object keyPaths:(NSArray *)keyPaths options:(int)options queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue block:(TOObservationBlock)block
 {
@@ -53,48 +55,201 @@ static void *TOKVOObservationContext = (void *)&TOKVOObservationContextVar;
     return self;
 }
 
+- (instancetype)initWithObserver:(nullable id)observer object:(id)object keyPaths:(NSArray *)keyPaths options:(int)options queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue batchBlock:(nullable TOCollatedObservationBlock)block
+{
+    if (!(self = [super initWithObserver:observer object:object queue:queue gcdQueue:gcdQueue batchBlock:block]))
+        return nil;
+    _keyPaths = keyPaths;
+    _options = options;
+    return self;
+}
+
+- (nullable instancetype)eventCopy
+{
+    // made with the batch initializer even when batchBlock is nil, copies for deliversEventCopies don't need a block
+    TOKVOObservation *copy = [[[self class] alloc] initWithObserver:self.observer object:self.object keyPaths:self.keyPaths options:self.options queue:self.queue gcdQueue:self.gcdQueue batchBlock:self.batchBlock];
+    copy.sourceObservation = self;
+    return copy;
+}
+
 - (void)registerInternal
 {
     NSAssert1(!self.registered, @"Attempted double-register of %@", self);
     NSAssert1(self.keyPaths != nil, @"Nil 'keyPaths' property when registering observation for %@", self);
     NSAssert1(self.keyPaths.count > 0, @"Empty 'keyPaths' property when registering observation for %@", self);
+    // shared with the object's other KVO observations, so only the first of each key path registers with KVO
+    id object = self.object;
+    if (object == nil)
+        return;
+    NSKeyValueObservingOptions options = self.options;
+    if (self.distinctUntilChanged != TODistinctComparisonNone)
+        options |= NSKeyValueObservingOptionOld | NSKeyValueObservingOptionNew; // for comparing
+    self.multiplexer = [TOKVOMultiplexer multiplexerForObject:object];
     for (NSString *keyPath in self.keyPaths) {
-        [self.object addObserver:self forKeyPath:keyPath options:self.options context:TOKVOObservationContext];
+        [self.multiplexer addObservation:self forKeyPath:keyPath options:options];
     }
 }
 
-- (void)observeValueForKeyPath:(nullable NSString *)keyPath ofObject:(nullable id)object change:(nullable NSDictionary *)change context:(nullable void *)context
+- (BOOL)isUnchangedFrom:(nullable id)oldValue to:(nullable id)newValue
+{
+    if (oldValue == nil || newValue == nil)
+        return NO; // not both in the change, such as an initial or prior one, so can't be compared
+    TODistinctComparator comparator = self.distinctComparator;
+    if (comparator != nil)
+        return comparator(oldValue, newValue);
+    if (oldValue == newValue)
+        return YES;
+    return self.distinctUntilChanged == TODistinctComparisonEqual && [oldValue isEqual:newValue];
+}
+
+- (void)observeChange:(nullable NSDictionary *)change forKeyPath:(NSString *)keyPath
 {
-    if (context == TOKVOObservationContext) {
-        NSAssert2([self.keyPaths containsObject:keyPath], @"Invoked with unexpected keypath '%@' %@", keyPath, self);
-        [self invokeOnQueueAfter:^{
-            self.keyPath = keyPath;
-            self.changeDict = change;
-            self.kind = [(NSNumber *)change[NSKeyValueChangeKindKey] unsignedIntegerValue];
-            self.prior = [(NSNumber *)change[NSKeyValueChangeNotificationIsPriorKey] unsignedIntegerValue];
-            self.changedValue = change[NSKeyValueChangeNewKey];
-            self.oldValue = change[NSKeyValueChangeOldKey];
-            self.indexes = change[NSKeyValueChangeIndexesKey];
-        }];
+    NSAssert2([self.keyPaths containsObject:keyPath], @"Invoked with unexpected keypath '%@' %@", keyPath, self);
+    if (self.distinctUntilChanged != TODistinctComparisonNone
+        && [(NSNumber *)change[NSKeyValueChangeKindKey] unsignedIntegerValue] == NSKeyValueChangeSetting
+        && ![(NSNumber *)change[NSKeyValueChangeNotificationIsPriorKey] boolValue]
+        && [self isUnchangedFrom:change[NSKeyValueChangeOldKey] to:change[NSKeyValueChangeNewKey]])
+        return; // dropped before anything is queued
+    [self invokeOnQueueForEvent:^(TOKVOObservation *observation) {
+        [observation takeChange:change forKeyPath:keyPath];
+    }];
+}
+
+- (void)observeNativeChangeToKeyPath:(NSString *)keyPath oldValue:(nullable id)oldValue newValue:(nullable id)newValue prior:(BOOL)prior
+{
+    NSAssert2([self.keyPaths containsObject:keyPath], @"Invoked with unexpected keypath '%@' %@", keyPath, self);
+    if (self.distinctUntilChanged != TODistinctComparisonNone && !prior && [self isUnchangedFrom:oldValue to:newValue])
+        return;
+    [self invokeOnQueueForEvent:^(TOKVOObservation *observation) {
+        [observation takeNativeChangeToKeyPath:keyPath oldValue:oldValue newValue:newValue prior:prior];
+    }];
+}
+
+- (void)takeNativeChangeToKeyPath:(NSString *)keyPath oldValue:(nullable id)oldValue newValue:(nullable id)newValue prior:(BOOL)prior
+{
+    self.keyPath = keyPath;
+    _changeDict = nil;
+    _nativeChange = YES;
+    _nativePrior = prior;
+    _nativeChangedValue = newValue;
+    _nativeOldValue = oldValue;
+}
+
+- (nullable NSDictionary *)changeDict
+{
+    if (_changeDict == nil && _nativeChange) {
+        // a native change, built only for blocks that ask for it
+        NSMutableDictionary *change = [NSMutableDictionary dictionaryWithObject:@(self.kind) forKey:NSKeyValueChangeKindKey];
+        if (self.prior)
+            change[NSKeyValueChangeNotificationIsPriorKey] = @YES;
+        if (self.changedValue != nil)
+            change[NSKeyValueChangeNewKey] = self.changedValue;
+        if (self.oldValue != nil)
+            change[NSKeyValueChangeOldKey] = self.oldValue;
+        _changeDict = [change copy];
     }
-    else {
-        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+    return _changeDict;
+}
+
+- (void)takeChange:(nullable NSDictionary *)change forKeyPath:(nullable NSString *)keyPath
+{
+    // most blocks read one or two of the properties below, so each is decoded from the change only when asked for;
+    // a native change's values left from before are released here rather than held until the next native change
+    self.keyPath = keyPath;
+    _changeDict = change;
+    if (_nativeChange) {
+        _nativeChange = NO;
+        _nativeChangedValue = nil;
+        _nativeOldValue = nil;
     }
 }
 
+- (NSUInteger)kind
+{
+    if (_nativeChange)
+        return NSKeyValueChangeSetting;
+    return [(NSNumber *)_changeDict[NSKeyValueChangeKindKey] unsignedIntegerValue];
+}
+
+- (BOOL)isPrior
+{
+    if (_nativeChange)
+        return _nativePrior;
+    return [(NSNumber *)_changeDict[NSKeyValueChangeNotificationIsPriorKey] boolValue];
+}
+
+- (nullable id)changedValue
+{
+    if (_nativeChange)
+        return _nativeChangedValue;
+    return _changeDict[NSKeyValueChangeNewKey];
+}
+
+- (nullable id)oldValue
+{
+    if (_nativeChange)
+        return _nativeOldValue;
+    return _changeDict[NSKeyValueChangeOldKey];
+}
+
+- (nullable NSIndexSet *)indexes
+{
+    if (_nativeChange)
+        return nil;
+    return _changeDict[NSKeyValueChangeIndexesKey];
+}
+
+- (void)takeEventFromCopy:(TOObservation *)event
+{
+    // copied as is, still undecoded, and with a native change's values since it has no dictionary to take them from
+    TOKVOObservation *copy = (TOKVOObservation *)event;
+    self.keyPath = copy.keyPath;
+    _changeDict = copy->_changeDict;
+    _nativeChange = copy->_nativeChange;
+    _nativePrior = copy->_nativePrior;
+    _nativeChangedValue = copy->_nativeChangedValue;
+    _nativeOldValue = copy->_nativeOldValue;
+}
+
+- (void)clearEvent
+{
+    [self takeChange:nil forKeyPath:nil];
+}
+
 - (void)deregisterInternal
 {
     NSAssert1(self.registered, @"Attempted double-removal of %@", self);
     NSAssert1(self.keyPaths != nil, @"Nil 'keyPaths' property when deregistering observation for %@", self);
     NSAssert1(self.keyPaths.count > 0, @"Empty 'keyPaths' property when deregistering observation for %@", self);
     for (NSString *keyPath in self.keyPaths) {
-        [self.object removeObserver:self forKeyPath:keyPath context:NULL];
+        [self.multiplexer removeObservation:self forKeyPath:keyPath];
     }
+    self.multiplexer = nil;
+}
+
++ (BOOL)observesNativelyInstancesOfClass:(Class)cls
+{
+    return [TOKVONativeEngine isEnabledForClass:cls];
+}
+
++ (void)setObservesNatively:(BOOL)natively instancesOfClass:(Class)cls
+{
+    [TOKVONativeEngine setEnabled:natively forClass:cls];
+}
+
++ (NSString *)hashKeyForKeyPaths:(NSArray *)keyPaths
+{
+    return [@"kvo|" stringByAppendingString:[keyPaths componentsJoinedByString:@","]];
+}
+
+- (nullable NSString *)hashKey
+{
+    return [TOKVOObservation hashKeyForKeyPaths:self.keyPaths];
 }
 
 + (BOOL)removeForObserver:(nullable id)observer object:(id)object keyPaths:(NSArray *)keyPaths
 {
-    TOObservation *observation = [self findObservationForObserver:observer object:object matchingTest:^BOOL(TOObservation *observation) {
+    TOObservation *observation = [self findObservationForObserver:observer object:object hashKey:[TOKVOObservation hashKeyForKeyPaths:keyPaths] matchingTest:^BOOL(TOObservation *observation) {
         return [observation isKindOfClass:[TOKVOObservation class]] && [((TOKVOObservation *)observation).keyPaths isEqualToArray:keyPaths];
     }];
     if (observation != nil) {
@@ -0,0 +1,30 @@
+//
+//  TOKVOScalarObservation+Private.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOKVOScalarObservation.h"
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#define TO_nullable nullable
+#else
+#define TO_nullable
+#endif
+
+@interface TOKVOScalarObservation (Private)
+
+// each returns nil if the object's class has no getter for the key that can be observed as a scalar
+- (TO_nullable instancetype)initWithObject:(id)object key:(NSString *)key queue:(TO_nullable NSOperationQueue *)queue gcdQueue:(TO_nullable dispatch_queue_t)gcdQueue doubleBlock:(TODoubleObservationBlock)block;
+- (TO_nullable instancetype)initWithObject:(id)object key:(NSString *)key queue:(TO_nullable NSOperationQueue *)queue gcdQueue:(TO_nullable dispatch_queue_t)gcdQueue integerBlock:(TOIntegerObservationBlock)block;
+- (TO_nullable instancetype)initWithObject:(id)object key:(NSString *)key queue:(TO_nullable NSOperationQueue *)queue gcdQueue:(TO_nullable dispatch_queue_t)gcdQueue boolBlock:(TOBoolObservationBlock)block;
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
+#undef TO_nullable
@@ -0,0 +1,53 @@
+//
+//  TOKVOScalarObservation.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOKVOObservation.h"
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#define TO_nullable nullable
+#else
+#define TO_nullable
+#endif
+
+typedef void (^TODoubleObservationBlock)(TOKVOObservation *observation, double oldValue, double newValue);
+typedef void (^TOIntegerObservationBlock)(TOKVOObservation *observation, NSInteger oldValue, NSInteger newValue);
+typedef void (^TOBoolObservationBlock)(TOKVOObservation *observation, BOOL oldValue, BOOL newValue);
+
+/**
+ *  A KVO observation of a single numeric key, whose block is passed the key's old and new values as scalars rather
+ *  than as `NSNumber` objects.
+ *
+ *  Returned from each `TotalObserverKVO` `to_observe...Double`, `Integer` or `Bool` `ChangesToKeyPath:` method. The
+ *  value is read on the thread that changed it by calling the key's getter directly, through an implementation looked
+ *  up when the observation is created, and the change dictionary isn't used at all. The old value is the one read for
+ *  the previous change, or when the observation was registered. When the value read is equal to the old one, the
+ *  change is dropped before it's queued, and the block isn't called.
+ *
+ *  The getter can return any integer or floating point type, or `BOOL`, which is converted to the observation's type.
+ *  `changedValue` and `oldValue` box the values when asked for, and `changeDict` is nil.
+ */
+@interface TOKVOScalarObservation : TOKVOObservation
+
+/**
+ *  Whether instances of the class have a getter for the key that can be observed as a scalar. Key paths of more than
+ *  one key can't be.
+ *
+ *  @param cls The class of the object to observe.
+ *  @param key The key to observe.
+ *
+ *  @return `YES` if the class has a getter for the key returning an integer or floating point type, or `BOOL`.
+ */
++ (BOOL)canObserveInstancesOfClass:(Class)cls key:(NSString *)key;
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
+#undef TO_nullable
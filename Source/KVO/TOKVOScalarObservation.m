@@ -0,0 +1,282 @@
+//
+//  TOKVOScalarObservation.m
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOKVOScalarObservation.h"
+#import "TOKVOScalarObservation+Private.h"
+#import "TOKVOObservation+Private.h"
+#import "TOObservation+Private.h"
+#import <objc/runtime.h>
+#import <pthread.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#else
+#define nullable
+#endif
+
+typedef NS_ENUM(NSUInteger, TOScalarKind) {
+    TOScalarKindDouble,
+    TOScalarKindInteger,
+    TOScalarKindBool
+};
+
+typedef union {
+    double doubleValue;
+    NSInteger integerValue;
+    BOOL boolValue;
+} TOScalarValue;
+
+static const char *TOSupportedScalarTypes = "cBsilqCSILQfd";
+
+// the key's getter, or NULL if the class doesn't have one returning a supported type
+static IMP _Nullable TOScalarGetterForKey(Class cls, NSString *key, SEL *selectorOut, char *typeOut)
+{
+    if (key.length == 0 || [key rangeOfString:@"."].location != NSNotFound)
+        return NULL;
+    SEL selector = NSSelectorFromString(key);
+    Method method = class_getInstanceMethod(cls, selector);
+    if (method == NULL) {
+        NSString *capitalizedKey = [[key substringToIndex:1].uppercaseString stringByAppendingString:[key substringFromIndex:1]];
+        selector = NSSelectorFromString([@"is" stringByAppendingString:capitalizedKey]);
+        method = class_getInstanceMethod(cls, selector);
+    }
+    if (method == NULL || method_getNumberOfArguments(method) != 2)
+        return NULL;
+    
+    char returnType[64];
+    method_getReturnType(method, returnType, sizeof(returnType));
+    const char *type = returnType;
+    while (*type != '\0' && strchr("rnNoORV", *type) != NULL) {
+        ++type; // skip qualifiers
+    }
+    if (type[0] == '\0' || type[1] != '\0' || strchr(TOSupportedScalarTypes, type[0]) == NULL)
+        return NULL;
+    
+    *selectorOut = selector;
+    *typeOut = type[0];
+    return method_getImplementation(method);
+}
+
+#define TO_CALL_GETTER(type) ((type (*)(id, SEL))getter)(object, selector)
+
+static TOScalarValue TOReadScalar(id object, SEL selector, IMP getter, char type, TOScalarKind kind)
+{
+    double floatingValue = 0;
+    long long integerValue = 0;
+    BOOL floating = NO;
+    switch (type) {
+        case 'f': floatingValue = TO_CALL_GETTER(float); floating = YES; break;
+        case 'd': floatingValue = TO_CALL_GETTER(double); floating = YES; break;
+        case 'c': integerValue = TO_CALL_GETTER(char); break;
+        case 'B': integerValue = TO_CALL_GETTER(bool); break;
+        case 's': integerValue = TO_CALL_GETTER(short); break;
+        case 'i': integerValue = TO_CALL_GETTER(int); break;
+        case 'l': integerValue = TO_CALL_GETTER(long); break;
+        case 'q': integerValue = TO_CALL_GETTER(long long); break;
+        case 'C': integerValue = TO_CALL_GETTER(unsigned char); break;
+        case 'S': integerValue = TO_CALL_GETTER(unsigned short); break;
+        case 'I': integerValue = TO_CALL_GETTER(unsigned int); break;
+        case 'L': integerValue = (long long)TO_CALL_GETTER(unsigned long); break;
+        case 'Q': integerValue = (long long)TO_CALL_GETTER(unsigned long long); break;
+    }
+    
+    TOScalarValue value;
+    switch (kind) {
+        case TOScalarKindDouble: value.doubleValue = floating ? floatingValue : (double)integerValue; break;
+        case TOScalarKindInteger: value.integerValue = floating ? (NSInteger)floatingValue : (NSInteger)integerValue; break;
+        case TOScalarKindBool: value.boolValue = floating ? floatingValue != 0 : integerValue != 0; break;
+    }
+    return value;
+}
+
+static BOOL TOScalarValuesEqual(TOScalarValue a, TOScalarValue b, TOScalarKind kind)
+{
+    switch (kind) {
+        case TOScalarKindDouble: return a.doubleValue == b.doubleValue;
+        case TOScalarKindInteger: return a.integerValue == b.integerValue;
+        case TOScalarKindBool: return a.boolValue == b.boolValue;
+    }
+    return NO;
+}
+
+static NSNumber *TOBoxScalar(TOScalarValue value, TOScalarKind kind)
+{
+    switch (kind) {
+        case TOScalarKindDouble: return @(value.doubleValue);
+        case TOScalarKindInteger: return @(value.integerValue);
+        case TOScalarKindBool: return @(value.boolValue);
+    }
+    return nil;
+}
+
+
+@implementation TOKVOScalarObservation {
+    TOScalarKind _scalarKind;
+    SEL _getterSelector;
+    IMP _getter;
+    char _getterType;
+    pthread_mutex_t _valueMutex; // held across reading the getter, so not a striped lock
+    TOScalarValue _lastValue;    // guarded by _valueMutex
+    
+    // the event's values
+    TOScalarValue _oldScalar;
+    TOScalarValue _newScalar;
+}
+
++ (BOOL)canObserveInstancesOfClass:(Class)cls key:(NSString *)key
+{
+    SEL selector;
+    char type;
+    return TOScalarGetterForKey(cls, key, &selector, &type) != NULL;
+}
+
+- (nullable instancetype)initWithObject:(id)object key:(NSString *)key kind:(TOScalarKind)kind queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue block:(TOAnonymousObservationBlock)block
+{
+    SEL selector;
+    char type;
+    IMP getter = TOScalarGetterForKey(object_getClass(object), key, &selector, &type);
+    if (getter == NULL)
+        return nil;
+    // no options, since values are read from the getter rather than the change dictionary
+    if (!(self = [super initWithObject:object keyPaths:@[key] options:0 queue:queue gcdQueue:gcdQueue block:block]))
+        return nil;
+    _scalarKind = kind;
+    _getterSelector = selector;
+    _getter = getter;
+    _getterType = type;
+    pthread_mutex_init(&_valueMutex, NULL);
+    return self;
+}
+
+- (instancetype)initCopyOfObservation:(TOKVOScalarObservation *)observation
+{
+    // for eventCopy, set up as the original was rather than looking up its getter again
+    if (!(self = [super initWithObserver:observation.observer object:observation.object keyPaths:observation.keyPaths options:observation.options queue:observation.queue gcdQueue:observation.gcdQueue batchBlock:observation.batchBlock]))
+        return nil;
+    _scalarKind = observation->_scalarKind;
+    _getterSelector = observation->_getterSelector;
+    _getter = observation->_getter;
+    _getterType = observation->_getterType;
+    pthread_mutex_init(&_valueMutex, NULL);
+    return self;
+}
+
+- (void)dealloc
+{
+    pthread_mutex_destroy(&_valueMutex);
+}
+
+- (nullable instancetype)initWithObject:(id)object key:(NSString *)key queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue doubleBlock:(TODoubleObservationBlock)block
+{
+    return [self initWithObject:object key:key kind:TOScalarKindDouble queue:queue gcdQueue:gcdQueue block:^(TOObservation *obs) {
+        TOKVOScalarObservation *observation = (TOKVOScalarObservation *)obs;
+        block(observation, observation->_oldScalar.doubleValue, observation->_newScalar.doubleValue);
+    }];
+}
+
+- (nullable instancetype)initWithObject:(id)object key:(NSString *)key queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue integerBlock:(TOIntegerObservationBlock)block
+{
+    return [self initWithObject:object key:key kind:TOScalarKindInteger queue:queue gcdQueue:gcdQueue block:^(TOObservation *obs) {
+        TOKVOScalarObservation *observation = (TOKVOScalarObservation *)obs;
+        block(observation, observation->_oldScalar.integerValue, observation->_newScalar.integerValue);
+    }];
+}
+
+- (nullable instancetype)initWithObject:(id)object key:(NSString *)key queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue boolBlock:(TOBoolObservationBlock)block
+{
+    return [self initWithObject:object key:key kind:TOScalarKindBool queue:queue gcdQueue:gcdQueue block:^(TOObservation *obs) {
+        TOKVOScalarObservation *observation = (TOKVOScalarObservation *)obs;
+        block(observation, observation->_oldScalar.boolValue, observation->_newScalar.boolValue);
+    }];
+}
+
+- (void)registerInternal
+{
+    // the old value for the first change
+    id object = self.object;
+    if (object != nil) {
+        pthread_mutex_lock(&_valueMutex);
+        _lastValue = TOReadScalar(object, _getterSelector, _getter, _getterType, _scalarKind);
+        pthread_mutex_unlock(&_valueMutex);
+    }
+    [super registerInternal];
+}
+
+- (void)observeChange:(nullable NSDictionary *)change forKeyPath:(NSString *)keyPath
+{
+    [self observeScalarChangeToKeyPath:keyPath];
+}
+
+- (void)observeNativeChangeToKeyPath:(NSString *)keyPath oldValue:(nullable id)oldValue newValue:(nullable id)newValue prior:(BOOL)prior
+{
+    [self observeScalarChangeToKeyPath:keyPath];
+}
+
+- (void)observeScalarChangeToKeyPath:(NSString *)keyPath
+{
+    id object = self.object;
+    if (object == nil)
+        return;
+    
+    // read and compared together, so a change racing with this one can't leave an older value behind as the last
+    pthread_mutex_lock(&_valueMutex);
+    TOScalarValue newValue = TOReadScalar(object, _getterSelector, _getter, _getterType, _scalarKind);
+    TOScalarValue oldValue = _lastValue;
+    BOOL changed = !TOScalarValuesEqual(oldValue, newValue, _scalarKind);
+    if (changed)
+        _lastValue = newValue;
+    pthread_mutex_unlock(&_valueMutex);
+    
+    if (!changed)
+        return; // dropped before anything is queued
+    
+    [self invokeOnQueueForEvent:^(TOKVOScalarObservation *observation) {
+        [observation takeChange:nil forKeyPath:keyPath];
+        observation->_oldScalar = oldValue;
+        observation->_newScalar = newValue;
+    }];
+}
+
+- (void)takeEventFromCopy:(TOObservation *)event
+{
+    [super takeEventFromCopy:event];
+    TOKVOScalarObservation *copy = (TOKVOScalarObservation *)event;
+    _oldScalar = copy->_oldScalar;
+    _newScalar = copy->_newScalar;
+}
+
+- (nullable instancetype)eventCopy
+{
+    // not the inherited batch initializer, which would leave the copy's mutex and getter unset
+    TOKVOScalarObservation *copy = [[[self class] alloc] initCopyOfObservation:self];
+    copy.sourceObservation = self;
+    return copy;
+}
+
+- (NSUInteger)kind
+{
+    return NSKeyValueChangeSetting;
+}
+
+- (nullable id)changedValue
+{
+    return TOBoxScalar(_newScalar, _scalarKind);
+}
+
+- (nullable id)oldValue
+{
+    return TOBoxScalar(_oldScalar, _scalarKind);
+}
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#else
+#undef nullable
+#endif
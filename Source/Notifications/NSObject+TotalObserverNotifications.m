@@ -39,6 +39,36 @@ NS_ASSUME_NONNULL_BEGIN
     return observation;
 }
 
+- (nullable TONotificationObservation *)to_observeForNotifications:(id)object named:(NSString *)name onExecutor:(nullable id<TOExecutor>)executor withBlock:(TOObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:object name:name executor:executor block:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TONotificationObservation *)to_observeForNotifications:(id)object named:(NSString *)name onQueue:(NSOperationQueue *)queue withBatchBlock:(TOCollatedObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:object name:name queue:queue gcdQueue:nil batchBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TONotificationObservation *)to_observeForNotifications:(id)object named:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBatchBlock:(TOCollatedObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:object name:name queue:nil gcdQueue:queue batchBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TONotificationObservation *)to_observeForNotifications:(id)object named:(NSString *)name onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:object name:name queue:nil gcdQueue:queue block:block];
+    observation.rateLimit = rateLimit;
+    observation.rateLimitInterval = interval;
+    [observation register];
+    return observation;
+}
+
 
 - (nullable TONotificationObservation *)to_observeAllNotificationsNamed:(NSString *)name withBlock:(TOObservationBlock)block
 {
@@ -61,6 +91,36 @@ NS_ASSUME_NONNULL_BEGIN
     return observation;
 }
 
+- (nullable TONotificationObservation *)to_observeAllNotificationsNamed:(NSString *)name onExecutor:(nullable id<TOExecutor>)executor withBlock:(TOObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:nil name:name executor:executor block:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TONotificationObservation *)to_observeAllNotificationsNamed:(NSString *)name onQueue:(NSOperationQueue *)queue withBatchBlock:(TOCollatedObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:nil name:name queue:queue gcdQueue:nil batchBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TONotificationObservation *)to_observeAllNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBatchBlock:(TOCollatedObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:nil name:name queue:nil gcdQueue:queue batchBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TONotificationObservation *)to_observeAllNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:nil name:name queue:nil gcdQueue:queue block:block];
+    observation.rateLimit = rateLimit;
+    observation.rateLimitInterval = interval;
+    [observation register];
+    return observation;
+}
+
 
 - (nullable TONotificationObservation *)to_observeOwnNotificationsNamed:(NSString *)name withBlock:(TOObservationBlock)block
 {
@@ -83,6 +143,36 @@ NS_ASSUME_NONNULL_BEGIN
     return observation;
 }
 
+- (nullable TONotificationObservation *)to_observeOwnNotificationsNamed:(NSString *)name onExecutor:(nullable id<TOExecutor>)executor withBlock:(TOObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:self name:name executor:executor block:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TONotificationObservation *)to_observeOwnNotificationsNamed:(NSString *)name onQueue:(NSOperationQueue *)queue withBatchBlock:(TOCollatedObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:self name:name queue:queue gcdQueue:nil batchBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TONotificationObservation *)to_observeOwnNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBatchBlock:(TOCollatedObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:self name:name queue:nil gcdQueue:queue batchBlock:block];
+    [observation register];
+    return observation;
+}
+
+- (nullable TONotificationObservation *)to_observeOwnNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObserver:self object:self name:name queue:nil gcdQueue:queue block:block];
+    observation.rateLimit = rateLimit;
+    observation.rateLimitInterval = interval;
+    [observation register];
+    return observation;
+}
+
 
 - (nullable TONotificationObservation *)to_observeNotificationsNamed:(NSString *)name withBlock:(TOAnonymousObservationBlock)block
 {
@@ -105,6 +195,13 @@ NS_ASSUME_NONNULL_BEGIN
     return observation;
 }
 
+- (nullable TONotificationObservation *)to_observeNotificationsNamed:(NSString *)name onExecutor:(nullable id<TOExecutor>)executor withBlock:(TOAnonymousObservationBlock)block
+{
+    TONotificationObservation *observation = [[TONotificationObservation alloc] initWithObject:self name:name executor:executor block:block];
+    [observation register];
+    return observation;
+}
+
 
 - (BOOL)to_stopObservingForNotifications:(id)object named:(NSString *)name
 {
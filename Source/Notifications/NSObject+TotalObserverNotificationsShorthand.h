@@ -75,6 +75,79 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (TO_nullable TONotificationObservation *)observeForNotifications:(id)object named:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBlock:(TOObservationBlock)block;
 
+/**
+ *  Receiver observes notifications posted with given name by a given object, calling its block using the given
+ *  executor.
+ *
+ *  Variation on `observeForNotifications:named:withBlock:` that adds an executor parameter, which becomes the
+ *  observation's `executor`. See the description for that method.
+ *
+ *  @param object   The object to observe.
+ *  @param name     The notification name to observe.
+ *  @param executor The executor with which to call `block`, or `nil` to call it as each notification is posted.
+ *  @param block    The block to call when observation is triggered, is passed the receiver (which can be used in place
+ *                  of a weakly captured self), and the observation (same as method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeForNotifications:(id)object named:(NSString *)name onExecutor:(TO_nullable id<TOExecutor>)executor withBlock:(TOObservationBlock)block;
+
+/**
+ *  Receiver observes notifications posted with given name by a given object, calling its batch block on the given
+ *  operation queue with all the notifications that occur while waiting for that queue.
+ *
+ *  Variation on `observeForNotifications:named:onQueue:withBlock:` whose block is passed an array of observations,
+ *  one for each notification in the order they occurred, instead of being called once per notification. See the
+ *  description for that method, and the `batchBlock` property of `TOObservation`.
+ *
+ *  @param object The object to observe.
+ *  @param name   The notification name to observe.
+ *  @param queue  The operation queue on which to call `block`.
+ *  @param block  The block to call with each batch, is passed the receiver (which can be used in place of a weakly
+ *                captured self), and an array of observation copies each describing one notification.
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeForNotifications:(id)object named:(NSString *)name onQueue:(NSOperationQueue *)queue withBatchBlock:(TOCollatedObservationBlock)block;
+
+/**
+ *  Receiver observes notifications posted with given name by a given object, calling its batch block on the given GCD
+ *  dispatch queue with all the notifications that occur while waiting for that queue.
+ *
+ *  Variation on `observeForNotifications:named:onGCDQueue:withBlock:` whose block is passed an array of
+ *  observations, one for each notification in the order they occurred, instead of being called once per notification.
+ *  See the description for that method, and the `batchBlock` property of `TOObservation`.
+ *
+ *  @param object The object to observe.
+ *  @param name   The notification name to observe.
+ *  @param queue  The CGD dispatch queue on which to call `block`.
+ *  @param block  The block to call with each batch, is passed the receiver (which can be used in place of a weakly
+ *                captured self), and an array of observation copies each describing one notification.
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeForNotifications:(id)object named:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBatchBlock:(TOCollatedObservationBlock)block;
+
+/**
+ *  Receiver observes notifications posted with given name by a given object, calling its block on the given GCD
+ *  dispatch queue at a limited rate.
+ *
+ *  Variation on `observeForNotifications:named:onGCDQueue:withBlock:` that limits how often its block is called,
+ *  applying `rateLimit` and `interval` to notifications before they're passed to the queue. See the description for
+ *  that method, and the `rateLimit` property of `TOObservation`.
+ *
+ *  @param object    The object to observe.
+ *  @param name      The notification name to observe.
+ *  @param queue     The GCD dispatch queue on which to call `block`.
+ *  @param rateLimit How to limit the rate of calls to `block`.
+ *  @param interval  The interval used by `rateLimit`.
+ *  @param block     The block to call when the observation is triggered, is passed the receiver (which can be used
+ *                   in place of a weakly captured self), and the observation (same as method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeForNotifications:(id)object named:(NSString *)name onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block;
+
 
 /**
  *  Receiver stops observing notifications posted with given name by a given object.
@@ -140,6 +213,74 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (TO_nullable TONotificationObservation *)observeAllNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBlock:(TOObservationBlock)block;
 
+/**
+ *  Receiver observes all notifications posted with given name, calling its block using the given executor.
+ *
+ *  Variation on `observeAllNotificationsNamed:withBlock:` that adds an executor parameter, which becomes the
+ *  observation's `executor`. See the description for that method.
+ *
+ *  @param name     The notification name to observe.
+ *  @param executor The executor with which to call `block`, or `nil` to call it as each notification is posted.
+ *  @param block    The block to call when observation is triggered, is passed the receiver (which can be used in place
+ *                  of a weakly captured self), and the observation (same as method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeAllNotificationsNamed:(NSString *)name onExecutor:(TO_nullable id<TOExecutor>)executor withBlock:(TOObservationBlock)block;
+
+/**
+ *  Receiver observes notifications posted with given name by any object, calling its batch block on the given operation
+ *  queue with all the notifications that occur while waiting for that queue.
+ *
+ *  Variation on `observeAllNotificationsNamed:onQueue:withBlock:` whose block is passed an array of observations,
+ *  one for each notification in the order they occurred, instead of being called once per notification. See the
+ *  description for that method, and the `batchBlock` property of `TOObservation`.
+ *
+ *  @param name  The notification name to observe.
+ *  @param queue The operation queue on which to call `block`.
+ *  @param block The block to call with each batch, is passed the receiver (which can be used in place of a weakly
+ *               captured self), and an array of observation copies each describing one notification.
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeAllNotificationsNamed:(NSString *)name onQueue:(NSOperationQueue *)queue withBatchBlock:(TOCollatedObservationBlock)block;
+
+/**
+ *  Receiver observes notifications posted with given name by any object, calling its batch block on the given GCD
+ *  dispatch queue with all the notifications that occur while waiting for that queue.
+ *
+ *  Variation on `observeAllNotificationsNamed:onGCDQueue:withBlock:` whose block is passed an array of observations,
+ *  one for each notification in the order they occurred, instead of being called once per notification. See the
+ *  description for that method, and the `batchBlock` property of `TOObservation`.
+ *
+ *  @param name  The notification name to observe.
+ *  @param queue The CGD dispatch queue on which to call `block`.
+ *  @param block The block to call with each batch, is passed the receiver (which can be used in place of a weakly
+ *               captured self), and an array of observation copies each describing one notification.
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeAllNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBatchBlock:(TOCollatedObservationBlock)block;
+
+/**
+ *  Receiver observes notifications posted with given name by any object, calling its block on the given GCD dispatch
+ *  queue at a limited rate.
+ *
+ *  Variation on `observeAllNotificationsNamed:onGCDQueue:withBlock:` that limits how often its block is called,
+ *  applying `rateLimit` and `interval` to notifications before they're passed to the queue. See the description for
+ *  that method, and the `rateLimit` property of `TOObservation`.
+ *
+ *  @param name      The notification name to observe.
+ *  @param queue     The GCD dispatch queue on which to call `block`.
+ *  @param rateLimit How to limit the rate of calls to `block`.
+ *  @param interval  The interval used by `rateLimit`.
+ *  @param block     The block to call when the observation is triggered, is passed the receiver (which can be used
+ *                   in place of a weakly captured self), and the observation (same as method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeAllNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block;
+
 
 /**
  *  Receiver stops observing notifications posted with given name by a given object.
@@ -204,6 +345,21 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (TO_nullable TONotificationObservation *)observeNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBlock:(TOAnonymousObservationBlock)block;
 
+/**
+ *  Observe notifications posted with given name by the receiver, calling its block using the given executor.
+ *
+ *  Variation on `observeNotificationsNamed:withBlock:` that adds an executor parameter, which becomes the
+ *  observation's `executor`. See the description for that method.
+ *
+ *  @param name     The notification name to observe.
+ *  @param executor The executor with which to call `block`, or `nil` to call it as each notification is posted.
+ *  @param block    The block to call when the key path observation is triggered, is passed the observation (same as
+ *                  the method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeNotificationsNamed:(NSString *)name onExecutor:(TO_nullable id<TOExecutor>)executor withBlock:(TOAnonymousObservationBlock)block;
+
 
 /**
  *  Stops observing notifications posted with given name by the receiver.
@@ -270,6 +426,74 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (TO_nullable TONotificationObservation *)observeOwnNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBlock:(TOObservationBlock)block;
 
+/**
+ *  Receiver observes notifications it posts with given name, calling its block using the given executor.
+ *
+ *  Variation on `observeOwnNotificationsNamed:withBlock:` that adds an executor parameter, which becomes the
+ *  observation's `executor`. See the description for that method.
+ *
+ *  @param name     The notification name to observe.
+ *  @param executor The executor with which to call `block`, or `nil` to call it as each notification is posted.
+ *  @param block    The block to call when observation is triggered, is passed the receiver (which can be used in place
+ *                  of a weakly captured self), and the observation (same as method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeOwnNotificationsNamed:(NSString *)name onExecutor:(TO_nullable id<TOExecutor>)executor withBlock:(TOObservationBlock)block;
+
+/**
+ *  Receiver observes notifications it posts with given name, calling its batch block on the given operation queue with
+ *  all the notifications that occur while waiting for that queue.
+ *
+ *  Variation on `observeOwnNotificationsNamed:onQueue:withBlock:` whose block is passed an array of observations,
+ *  one for each notification in the order they occurred, instead of being called once per notification. See the
+ *  description for that method, and the `batchBlock` property of `TOObservation`.
+ *
+ *  @param name  The notification name to observe.
+ *  @param queue The operation queue on which to call `block`.
+ *  @param block The block to call with each batch, is passed the receiver (which can be used in place of a weakly
+ *               captured self), and an array of observation copies each describing one notification.
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeOwnNotificationsNamed:(NSString *)name onQueue:(NSOperationQueue *)queue withBatchBlock:(TOCollatedObservationBlock)block;
+
+/**
+ *  Receiver observes notifications it posts with given name, calling its batch block on the given GCD dispatch queue
+ *  with all the notifications that occur while waiting for that queue.
+ *
+ *  Variation on `observeOwnNotificationsNamed:onGCDQueue:withBlock:` whose block is passed an array of observations,
+ *  one for each notification in the order they occurred, instead of being called once per notification. See the
+ *  description for that method, and the `batchBlock` property of `TOObservation`.
+ *
+ *  @param name  The notification name to observe.
+ *  @param queue The CGD dispatch queue on which to call `block`.
+ *  @param block The block to call with each batch, is passed the receiver (which can be used in place of a weakly
+ *               captured self), and an array of observation copies each describing one notification.
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeOwnNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue withBatchBlock:(TOCollatedObservationBlock)block;
+
+/**
+ *  Receiver observes notifications posted with given name by itself, calling its block on the given GCD dispatch queue
+ *  at a limited rate.
+ *
+ *  Variation on `observeOwnNotificationsNamed:onGCDQueue:withBlock:` that limits how often its block is called,
+ *  applying `rateLimit` and `interval` to notifications before they're passed to the queue. See the description for
+ *  that method, and the `rateLimit` property of `TOObservation`.
+ *
+ *  @param name      The notification name to observe.
+ *  @param queue     The GCD dispatch queue on which to call `block`.
+ *  @param rateLimit How to limit the rate of calls to `block`.
+ *  @param interval  The interval used by `rateLimit`.
+ *  @param block     The block to call when the observation is triggered, is passed the receiver (which can be used
+ *                   in place of a weakly captured self), and the observation (same as method result).
+ *
+ *  @return An observation object. You often don't need to keep this result.
+ */
+- (TO_nullable TONotificationObservation *)observeOwnNotificationsNamed:(NSString *)name onGCDQueue:(dispatch_queue_t)queue rateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval withBlock:(TOObservationBlock)block;
+
 
 /**
  *  Receiver stops observing notifications it posts with given name.
@@ -19,6 +19,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (instancetype)initWithObserver:(TO_nullable id)observer object:(TO_nullable id)object name:(NSString *)name queue:(TO_nullable NSOperationQueue *)queue gcdQueue:(TO_nullable dispatch_queue_t)gcdQueue block:(TOObservationBlock)block;
 - (instancetype)initWithObject:(TO_nullable id)object name:(NSString *)name queue:(TO_nullable NSOperationQueue *)queue gcdQueue:(TO_nullable dispatch_queue_t)gcdQueue block:(TOAnonymousObservationBlock)block;
+- (instancetype)initWithObserver:(TO_nullable id)observer object:(TO_nullable id)object name:(NSString *)name queue:(TO_nullable NSOperationQueue *)queue gcdQueue:(TO_nullable dispatch_queue_t)gcdQueue batchBlock:(TO_nullable TOCollatedObservationBlock)block;
+- (instancetype)initWithObserver:(TO_nullable id)observer object:(TO_nullable id)object name:(NSString *)name executor:(TO_nullable id<TOExecutor>)executor block:(TOObservationBlock)block;
+- (instancetype)initWithObject:(TO_nullable id)object name:(NSString *)name executor:(TO_nullable id<TOExecutor>)executor block:(TOAnonymousObservationBlock)block;
 
 // TODO: consider making this private too
 //+ (BOOL)removeForObserver:(TO_nullable id)observer object:(TO_nullable id)object name:(NSString *)name;
@@ -22,6 +22,8 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, readwrite) NSNotification *notification;
 @property (nonatomic, readwrite, nullable) id postedObject;
 @property (nonatomic, readwrite, nullable) NSDictionary *userInfo;
+
+@property (nonatomic, nullable) id<NSObject> centerToken; // returned by addObserverForName:, what deregistering removes
 @end
 
 
@@ -43,41 +45,110 @@ NS_ASSUME_NONNULL_BEGIN
     return self;
 }
 
+- (instancetype)initWithObserver:(nullable id)observer object:(nullable id)object name:(NSString *)name queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue batchBlock:(nullable TOCollatedObservationBlock)block
+{
+    if (!(self = [super initWithObserver:observer object:object queue:queue gcdQueue:gcdQueue batchBlock:block]))
+        return nil;
+    _name = name;
+    return self;
+}
+
+- (instancetype)initWithObserver:(nullable id)observer object:(nullable id)object name:(NSString *)name executor:(nullable id<TOExecutor>)executor block:(TOObservationBlock)block
+{
+    if (!(self = [super initWithObserver:observer object:object executor:executor block:block]))
+        return nil;
+    _name = name;
+    return self;
+}
+
+- (instancetype)initWithObject:(nullable id)object name:(NSString *)name executor:(nullable id<TOExecutor>)executor block:(TOAnonymousObservationBlock)block
+{
+    if (!(self = [super initWithObject:object executor:executor block:block]))
+        return nil;
+    _name = name;
+    return self;
+}
+
+- (nullable instancetype)eventCopy
+{
+    // made with the batch initializer even when batchBlock is nil, copies for deliversEventCopies don't need a block
+    TONotificationObservation *copy = [[[self class] alloc] initWithObserver:self.observer object:self.object name:self.name queue:self.queue gcdQueue:self.gcdQueue batchBlock:self.batchBlock];
+    copy.sourceObservation = self;
+    return copy;
+}
+
+- (void)takeNotification:(nullable NSNotification *)notification
+{
+    self.notification = notification;
+    self.postedObject = notification.object;
+    self.userInfo = notification.userInfo;
+}
+
+- (void)takeEventFromCopy:(TOObservation *)event
+{
+    [self takeNotification:((TONotificationObservation *)event).notification];
+}
+
+- (void)clearEvent
+{
+    [self takeNotification:nil];
+}
+
 - (void)registerInternal
 {
     NSAssert1(!self.registered, @"Attempted double-register of %@", self);
     NSAssert1(self.name != nil, @"Nil 'name' property when registering observation for %@", self);
     typeof(self) __weak welf = self;
     if (self.queue != nil) {
-        [[NSNotificationCenter defaultCenter] addObserverForName:self.name object:self.object queue:self.queue usingBlock:^(NSNotification *notification) {
-            welf.notification = notification;
-            welf.postedObject = notification.object;
-            welf.userInfo = notification.userInfo;
-            [welf invoke];
+        self.centerToken = [[NSNotificationCenter defaultCenter] addObserverForName:self.name object:self.object queue:self.queue usingBlock:^(NSNotification *notification) {
+            if (welf.batchBlock != nil || welf.coalescesDeliveries) {
+                // already on the queue, but poster waits for this block, so batch or merge triggers by hopping onto it again
+                [welf handleNotification:notification];
+                return;
+            }
+            [welf invokeForEvent:^(TONotificationObservation *observation) {
+                [observation takeNotification:notification];
+            }];
         }];
     }
     else {
-        [[NSNotificationCenter defaultCenter] addObserverForName:self.name object:self.object queue:nil usingBlock:^(NSNotification *notification) {
-            [welf invokeOnQueueAfter:^{
-                welf.notification = notification;
-                welf.postedObject = notification.object;
-                welf.userInfo = notification.userInfo;
-            }];
+        self.centerToken = [[NSNotificationCenter defaultCenter] addObserverForName:self.name object:self.object queue:nil usingBlock:^(NSNotification *notification) {
+            [welf handleNotification:notification];
         }];
     }
 }
 
+- (void)handleNotification:(NSNotification *)notification
+{
+    [self invokeOnQueueForEvent:^(TONotificationObservation *observation) {
+        [observation takeNotification:notification];
+    }];
+}
+
 - (void)deregisterInternal
 {
     NSAssert1(self.registered, @"Attempted double-removal of %@", self);
     NSAssert1(self.name != nil, @"Nil 'name' property when deregistering observation for %@", self);
-    [[NSNotificationCenter defaultCenter] removeObserver:self name:self.name object:self.object];
+    // the block based registration is only removed using its token, the object property may also be nil by now
+    if (self.centerToken != nil)
+        [[NSNotificationCenter defaultCenter] removeObserver:self.centerToken];
+    self.centerToken = nil;
+}
+
++ (NSString *)hashKeyForName:(NSString *)name
+{
+    return [@"notification|" stringByAppendingString:name];
+}
+
+- (nullable NSString *)hashKey
+{
+    return [TONotificationObservation hashKeyForName:self.name];
 }
 
 + (BOOL)removeForObserver:(nullable id)observer object:(nullable id)object name:(NSString *)name
 {
     NSParameterAssert(observer != nil || object != nil);
-    TOObservation *observation = [self findObservationForObserver:observer object:object matchingTest:^BOOL(TOObservation *observation) {
+    TOObservation *observation = [self findObservationForObserver:observer object:object hashKey:[TONotificationObservation hashKeyForName:name] matchingTest:^BOOL(TOObservation *observation) {
         return [observation isKindOfClass:[TONotificationObservation class]] && [((TONotificationObservation *)observation).name isEqualToString:name];
     }];
     if (observation != nil) {
@@ -0,0 +1,74 @@
+//
+//  TODeliveryBuffer.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+//  Bounded buffer of triggers waiting for delivery, held by an observation whose `maximumPendingDeliveries` or
+//  `maximumDeliveryDelay` is set. Each trigger is an event copy of the observation, see `eventCopy`. Triggers are
+//  added on the triggering thread and taken one at a time by a single drain running on the observation's executor.
+//
+//  Guarded by its own mutex rather than a striped lock, since producers may need to wait for space. A drain is given
+//  the buffer itself rather than the observation, so that it takes from the same buffer the trigger was added to.
+
+#import <Foundation/Foundation.h>
+#import "TOObservation.h"
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#define TO_nullable nullable
+#else
+#define TO_nullable
+#endif
+
+@interface TODeliveryBuffer : NSObject
+
+/**
+ *  Initializes and returns an empty buffer.
+ *
+ *  @param limit        The most triggers kept waiting, 0 for no limit.
+ *  @param policy       What to do with a trigger when `limit` triggers are already waiting.
+ *  @param maximumDelay How long a trigger can wait before it's dropped instead of delivered, 0 for no limit.
+ */
+- (instancetype)initWithObservation:(TOObservation *)observation limit:(NSUInteger)limit overflowPolicy:(TODeliveryOverflowPolicy)policy maximumDelay:(NSTimeInterval)maximumDelay;
+
+/**
+ *  The observation the triggers are delivered to, `nil` once it's been deallocated. (read-only)
+ */
+@property (nonatomic, readonly, weak, TO_nullable) TOObservation *observation;
+
+/**
+ *  The number of triggers dropped, whether on overflow or for waiting too long. (read-only)
+ */
+@property (nonatomic, readonly) NSUInteger droppedCount;
+
+/**
+ *  Add a trigger, applying the overflow policy if the buffer is full, which may block the calling thread. A blocked
+ *  trigger gives up when the buffer is shut down, or is dropped once it's waited `maximumDelay` if that's set, since
+ *  it would be dropped for waiting too long anyway. Triggers added after the buffer is shut down are ignored.
+ *
+ *  @param event An event copy describing the trigger.
+ *
+ *  @return `YES` if no drain was pending, in which case the caller must schedule one.
+ */
+- (BOOL)addEvent:(TOObservation *)event;
+
+/**
+ *  Take the oldest trigger that hasn't waited too long, dropping any older ones that have. Called repeatedly by the
+ *  drain until it returns `nil`, at which point the drain is no longer pending.
+ */
+- (TO_nullable TOObservation *)takeEvent;
+
+/**
+ *  Drop all triggers waiting and ignore any added later, without counting them as dropped, and let any blocked
+ *  producers continue. A pending drain will find nothing left to take.
+ */
+- (void)shutDown;
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
+#undef TO_nullable
@@ -0,0 +1,236 @@
+//
+//  TODeliveryBuffer.m
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TODeliveryBuffer.h"
+#import <mach/mach_time.h>
+#import <pthread.h>
+#import <stdatomic.h>
+#import <sys/time.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#else
+#define nullable
+#endif
+
+typedef struct {
+    void *event; // retained
+    uint64_t time; // mach_absolute_time of the trigger
+} TOBufferedEvent;
+
+static uint64_t TOMachTimeFromInterval(NSTimeInterval interval)
+{
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return (uint64_t)(interval * NSEC_PER_SEC * timebase.denom / timebase.numer);
+}
+
+
+@implementation TODeliveryBuffer {
+    pthread_mutex_t _mutex;
+    pthread_cond_t _spaceAvailable;
+    TOBufferedEvent *_entries;
+    NSUInteger _capacity; // always a power of 2, fixed if there's a limit
+    NSUInteger _head;
+    NSUInteger _count;
+    NSUInteger _limit;
+    TODeliveryOverflowPolicy _policy;
+    uint64_t _maximumDelay; // in mach absolute time units, 0 for none
+    NSTimeInterval _maximumDelayInterval; // the same, for bounding how long a blocked trigger waits
+    BOOL _shutDown;
+    BOOL _drainPending;
+    BOOL _draining;
+    pthread_t _drainingThread; // only valid while _draining
+    _Atomic(NSUInteger) _droppedCount;
+}
+
+- (instancetype)initWithObservation:(TOObservation *)observation limit:(NSUInteger)limit overflowPolicy:(TODeliveryOverflowPolicy)policy maximumDelay:(NSTimeInterval)maximumDelay
+{
+    if (!(self = [super init]))
+        return nil;
+    _observation = observation;
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_spaceAvailable, NULL);
+    _limit = limit;
+    _policy = policy;
+    _maximumDelay = maximumDelay > 0 ? TOMachTimeFromInterval(maximumDelay) : 0;
+    _maximumDelayInterval = maximumDelay > 0 ? maximumDelay : 0;
+    _capacity = 16;
+    while (_capacity < limit) {
+        _capacity *= 2;
+    }
+    _entries = malloc(_capacity * sizeof(TOBufferedEvent));
+    return self;
+}
+
+- (void)dealloc
+{
+    for (NSUInteger i = 0; i < _count; ++i) {
+        CFRelease(_entries[(_head + i) & (_capacity - 1)].event);
+    }
+    free(_entries);
+    pthread_mutex_destroy(&_mutex);
+    pthread_cond_destroy(&_spaceAvailable);
+}
+
+- (NSUInteger)droppedCount
+{
+    return atomic_load(&_droppedCount);
+}
+
+- (void)growIfFull
+{
+    if (_count < _capacity)
+        return;
+    TOBufferedEvent *entries = malloc(_capacity * 2 * sizeof(TOBufferedEvent));
+    for (NSUInteger i = 0; i < _count; ++i) {
+        entries[i] = _entries[(_head + i) & (_capacity - 1)];
+    }
+    free(_entries);
+    _entries = entries;
+    _capacity *= 2;
+    _head = 0;
+}
+
+- (TOBufferedEvent)popOldest
+{
+    TOBufferedEvent entry = _entries[_head];
+    _head = (_head + 1) & (_capacity - 1);
+    --_count;
+    return entry;
+}
+
+- (BOOL)addEvent:(TOObservation *)event
+{
+    TOObservation *droppedEvent NS_VALID_UNTIL_END_OF_SCOPE = nil; // released only after unlocking
+    BOOL accepted = YES;
+    BOOL scheduleDrain = NO;
+    uint64_t now = mach_absolute_time();
+
+    pthread_mutex_lock(&_mutex);
+
+    if (_shutDown) {
+        pthread_mutex_unlock(&_mutex);
+        return NO; // removed, so not counted as dropped
+    }
+    if (_limit > 0 && _count >= _limit) {
+        switch (_policy) {
+            case TODeliveryOverflowPolicyDropOldest:
+                droppedEvent = (__bridge_transfer TOObservation *)[self popOldest].event;
+                break;
+            case TODeliveryOverflowPolicyDropNewest:
+                accepted = NO;
+                break;
+            case TODeliveryOverflowPolicyBlockTrigger:
+                if (_draining && pthread_equal(_drainingThread, pthread_self())) {
+                    accepted = NO; // triggered from within its own delivery, waiting would never end
+                    break;
+                }
+                [self waitForSpace];
+                if (_shutDown) {
+                    pthread_mutex_unlock(&_mutex);
+                    return NO;
+                }
+                accepted = _count < _limit;
+                break;
+        }
+    }
+    if (accepted) {
+        [self growIfFull];
+        _entries[(_head + _count) & (_capacity - 1)] = (TOBufferedEvent){ (__bridge_retained void *)event, now };
+        ++_count;
+        scheduleDrain = !_drainPending;
+        _drainPending = YES;
+    }
+
+    pthread_mutex_unlock(&_mutex);
+
+    if (!accepted || droppedEvent != nil)
+        atomic_fetch_add(&_droppedCount, 1);
+    return scheduleDrain;
+}
+
+- (void)waitForSpace
+{
+    // called with the mutex held, returns with it held whether there's space, the buffer was shut down, or it timed out
+    if (_maximumDelayInterval == 0) {
+        while (_count >= _limit && !_shutDown) {
+            pthread_cond_wait(&_spaceAvailable, &_mutex);
+        }
+        return;
+    }
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    NSTimeInterval deadline = now.tv_sec + now.tv_usec / (NSTimeInterval)USEC_PER_SEC + _maximumDelayInterval;
+    struct timespec deadlineSpec;
+    deadlineSpec.tv_sec = (time_t)deadline;
+    deadlineSpec.tv_nsec = (long)((deadline - deadlineSpec.tv_sec) * NSEC_PER_SEC);
+    while (_count >= _limit && !_shutDown) {
+        if (pthread_cond_timedwait(&_spaceAvailable, &_mutex, &deadlineSpec) == ETIMEDOUT)
+            return;
+    }
+}
+
+- (nullable TOObservation *)takeEvent
+{
+    for (;;) {
+        pthread_mutex_lock(&_mutex);
+        if (_count == 0) {
+            _drainPending = NO;
+            _draining = NO;
+            pthread_mutex_unlock(&_mutex);
+            return nil;
+        }
+        TOBufferedEvent entry = [self popOldest];
+        _draining = YES;
+        _drainingThread = pthread_self();
+        pthread_cond_signal(&_spaceAvailable);
+        pthread_mutex_unlock(&_mutex);
+
+        TOObservation *event = (__bridge_transfer TOObservation *)entry.event;
+        if (_maximumDelay == 0 || mach_absolute_time() - entry.time <= _maximumDelay)
+            return event;
+        atomic_fetch_add(&_droppedCount, 1); // waited too long, released and skipped
+    }
+}
+
+- (void)shutDown
+{
+    pthread_mutex_lock(&_mutex);
+
+    _shutDown = YES;
+
+    // swap in an empty ring so the removed triggers are released after unlocking
+    TOBufferedEvent *entries = _entries;
+    NSUInteger head = _head;
+    NSUInteger count = _count;
+    NSUInteger capacity = _capacity;
+    _entries = malloc(_capacity * sizeof(TOBufferedEvent));
+    _head = 0;
+    _count = 0;
+    pthread_cond_broadcast(&_spaceAvailable);
+
+    pthread_mutex_unlock(&_mutex);
+
+    for (NSUInteger i = 0; i < count; ++i) {
+        CFRelease(entries[(head + i) & (capacity - 1)].event);
+    }
+    free(entries);
+}
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#else
+#undef nullable
+#endif
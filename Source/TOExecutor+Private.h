@@ -0,0 +1,23 @@
+//
+//  TOExecutor+Private.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOExecutor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  The GCD quality of service class for an `NSQualityOfService`, `QOS_CLASS_UNSPECIFIED` for
+ *  `NSQualityOfServiceDefault`. Used by executors and by observations delivering to a GCD queue themselves.
+ */
+qos_class_t TOQOSClassFromQualityOfService(NSQualityOfService qualityOfService);
+
+#ifdef __cplusplus
+}
+#endif
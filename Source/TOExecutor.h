@@ -0,0 +1,334 @@
+//
+//  TOExecutor.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#define TO_nullable nullable
+#else
+#define TO_nullable
+#endif
+
+/**
+ *  Something that runs work on an observation's behalf, deciding on which thread or queue its block gets called.
+ *  An observation's `queue` or `gcdQueue` are wrapped in one of the built-in executors below, or any executor can be
+ *  assigned to its `executor` property.
+ *
+ *  Executors must be safe to call from any thread.
+ */
+@protocol TOExecutor <NSObject>
+
+/**
+ *  Run the block, either before returning or later.
+ *
+ *  @param block The block to run.
+ */
+- (void)executeBlock:(dispatch_block_t)block;
+
+/**
+ *  Run the function with the given context, either before returning or later. Equivalent to `executeBlock:` with a
+ *  block that calls the function, but lets executors avoid allocating one, as with `dispatch_async_f`.
+ *
+ *  @param function The function to run.
+ *  @param context  The parameter to pass to `function`.
+ */
+- (void)executeFunction:(dispatch_function_t)function context:(TO_nullable void *)context;
+
+@optional
+
+/**
+ *  Run the block at the given quality of service, used for observations whose `qualityOfService` is set. Executors
+ *  that don't implement this are given the block through `executeBlock:` instead.
+ *
+ *  @param block            The block to run.
+ *  @param qualityOfService The quality of service to run it at, `NSQualityOfServiceDefault` meaning the same as
+ *                          `executeBlock:`.
+ */
+- (void)executeBlock:(dispatch_block_t)block qualityOfService:(NSQualityOfService)qualityOfService;
+
+/**
+ *  Run the function at the given quality of service, used for observations whose `qualityOfService` is set.
+ *  Executors that don't implement this are given the function through `executeFunction:context:` instead.
+ *
+ *  @param function         The function to run.
+ *  @param context          The parameter to pass to `function`.
+ *  @param qualityOfService The quality of service to run it at, `NSQualityOfServiceDefault` meaning the same as
+ *                          `executeFunction:context:`.
+ */
+- (void)executeFunction:(dispatch_function_t)function context:(TO_nullable void *)context qualityOfService:(NSQualityOfService)qualityOfService;
+
+@end
+
+
+/**
+ *  Runs everything synchronously on the calling thread.
+ */
+@interface TOInlineExecutor : NSObject <TOExecutor>
+
+/**
+ *  The shared instance, inline executors have no state.
+ */
++ (instancetype)sharedExecutor;
+
+@end
+
+
+/**
+ *  Runs everything asynchronously on a GCD queue. Used for observations created with a `gcdQueue`.
+ *
+ *  Work given a quality of service is wrapped in a block from `dispatch_block_create_with_qos_class`, which unlike
+ *  other work has to be allocated. The queue's own quality of service, if it has one, is still the lowest it runs at.
+ */
+@interface TOGCDQueueExecutor : NSObject <TOExecutor>
+
+/**
+ *  The GCD queue that work is run on. (read-only)
+ */
+@property (nonatomic, readonly) dispatch_queue_t queue;
+
+/**
+ *  Initializes and returns an executor for the given GCD queue.
+ */
+- (instancetype)initWithQueue:(dispatch_queue_t)queue NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+
+/**
+ *  Runs work synchronously if the calling thread is already running on its GCD queue, or on a queue targeting it,
+ *  and otherwise asynchronously on it. Avoids the hop through the queue when a trigger already occurs there, such as
+ *  a property changed on the main queue and observed for the main queue.
+ *
+ *  Tags the queue using `dispatch_queue_set_specific`, so this is only suitable for serial queues.
+ */
+@interface TOTargetQueueExecutor : TOGCDQueueExecutor
+@end
+
+
+/**
+ *  Runs everything asynchronously on an operation queue. Used for observations created with a `queue`.
+ *
+ *  Work given a quality of service is added as an operation with that `qualityOfService`, and a matching
+ *  `queuePriority` so that it's also started ahead of, or behind, other operations waiting in the queue.
+ */
+@interface TOOperationQueueExecutor : NSObject <TOExecutor>
+
+/**
+ *  The operation queue that work is run on. (read-only)
+ */
+@property (nonatomic, readonly) NSOperationQueue *operationQueue;
+
+/**
+ *  Initializes and returns an executor for the given operation queue.
+ */
+- (instancetype)initWithOperationQueue:(NSOperationQueue *)operationQueue NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+
+/**
+ *  Runs work asynchronously on a fixed number of dedicated threads, taking work in the order it was given. With more
+ *  than one thread, work can run concurrently and so finish out of order, as with a concurrent GCD queue.
+ *
+ *  Each thread runs work at the quality of service it was given, or otherwise that of the thread that gave it.
+ *
+ *  The threads exit once the executor is deallocated and they've finished all work already given to them.
+ */
+@interface TOThreadPoolExecutor : NSObject <TOExecutor>
+
+/**
+ *  The number of threads. (read-only)
+ */
+@property (nonatomic, readonly) NSUInteger threadCount;
+
+/**
+ *  Initializes and returns an executor, starting its threads.
+ *
+ *  @param threadCount The number of threads, must be greater than 0.
+ */
+- (instancetype)initWithThreadCount:(NSUInteger)threadCount NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+
+/**
+ *  Runs work asynchronously on a fixed number of dedicated threads, each with its own deque of work, and threads that
+ *  run out of work steal it from the others. Spreads work that fans out from a single trigger, such as a notification
+ *  observed many times over, across all cores while keeping each thread mostly on its own work.
+ *
+ *  Work given to the executor itself can run concurrently and in any order. For an observation whose triggers must be
+ *  delivered in order, give it its own `serialExecutor` instead, since those keep their work in order and separate
+ *  serial executors still run in parallel.
+ *
+ *  As with `TOThreadPoolExecutor`, work runs at the quality of service it was given, or otherwise that of the thread
+ *  that gave it.
+ *
+ *  The threads exit once the executor and all of its serial executors are deallocated, and they've finished all work
+ *  already given to them.
+ */
+@interface TOWorkStealingExecutor : NSObject <TOExecutor>
+
+/**
+ *  The number of threads. (read-only)
+ */
+@property (nonatomic, readonly) NSUInteger threadCount;
+
+/**
+ *  Initializes and returns an executor with one thread for each active processor, starting its threads.
+ */
+- (instancetype)init;
+
+/**
+ *  Initializes and returns an executor, starting its threads.
+ *
+ *  @param threadCount The number of threads, must be greater than 0.
+ */
+- (instancetype)initWithThreadCount:(NSUInteger)threadCount NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  A new executor which runs work on the receiver's threads but one item at a time, in the order it was given, like a
+ *  serial GCD queue targeting a concurrent one. Meant to be assigned to a single observation's `executor`.
+ */
+- (id<TOExecutor>)serialExecutor;
+
+@end
+
+
+/**
+ *  A fixed set of serial GCD queues, or shards, that observations are spread across by key. Each observation given
+ *  the executor for its own key has its work run in order on that shard, while observations on different shards run
+ *  in parallel. Used for observations created without a queue while `+[TOObservation shardsUnqueuedDeliveries]` is
+ *  set, keyed by the observation itself.
+ */
+@interface TOShardedExecutor : NSObject
+
+/**
+ *  The number of shards. (read-only)
+ */
+@property (nonatomic, readonly) NSUInteger shardCount;
+
+/**
+ *  The shared instance, with one shard for each active processor.
+ */
++ (instancetype)sharedExecutor;
+
+/**
+ *  Initializes and returns an executor with one shard for each active processor.
+ */
+- (instancetype)init;
+
+/**
+ *  Initializes and returns an executor, creating its shards.
+ *
+ *  @param shardCount The number of shards, must be greater than 0.
+ */
+- (instancetype)initWithShardCount:(NSUInteger)shardCount NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  The executor for the shard that the given key hashes to, the same one each time for the same key.
+ *
+ *  @param key Any pointer, typically the observation the executor is for.
+ */
+- (id<TOExecutor>)executorForKey:(const void *)key;
+
+@end
+
+
+/**
+ *  Schedules work fairly among the observations sharing a serial GCD queue. Rather than giving each delivery to the
+ *  queue as it's triggered, in which case one observation triggered in a burst holds up all others behind its backlog,
+ *  each observation is given its own executor from `executorWithWeight:` that keeps its work pending separately. The
+ *  queue is then given a single drain at a time, which takes turns between the observations with work pending, running
+ *  as many items in each turn as that observation's weight. A quiet observation's delivery therefore waits for at most
+ *  one turn of each other observation, however much they have pending.
+ *
+ *  Each executor keeps its own work in order. The drain gives the queue back after a bounded number of items, so other
+ *  work given directly to the queue isn't held up either. Work given a quality of service raises the drain's to the
+ *  highest of the observations it takes turns between.
+ */
+@interface TOFairQueueScheduler : NSObject
+
+/**
+ *  The serial GCD queue that work is run on. (read-only)
+ */
+@property (nonatomic, readonly) dispatch_queue_t queue;
+
+/**
+ *  Initializes and returns a scheduler for the given GCD queue.
+ *
+ *  @param queue A serial GCD queue, which may also have work given to it directly.
+ */
+- (instancetype)initWithQueue:(dispatch_queue_t)queue NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  A new executor with its own pending work, taking turns with the others on the receiver's queue. Meant to be
+ *  assigned to a single observation's `executor`.
+ *
+ *  @param weight The most items run in each of its turns, must be greater than 0.
+ */
+- (id<TOExecutor>)executorWithWeight:(NSUInteger)weight;
+
+@end
+
+
+/**
+ *  Gathers work for a single queue from any number of observations into one pending list, giving the queue a single
+ *  drain that runs it all in order. When one change triggers hundreds of observations delivering to the main queue,
+ *  the queue is then woken once rather than once for each, and an operation queue is given one operation rather than
+ *  one for each. Work given while the drain is running, such as deliveries triggered by the blocks it calls, is run by
+ *  that same drain. Used for observations created with a serial `queue` or `gcdQueue` while
+ *  `+[TOObservation aggregatesQueuedDeliveries]` is set.
+ *
+ *  Work runs in the order it was given, though ahead of any given to the queue directly while the drain waited to
+ *  start. The drain gives the queue back after a bounded number of items, so other work isn't held up indefinitely.
+ *  Work given a quality of service is run in the drain, which itself runs at the quality of service of the work that
+ *  scheduled it, or when it continues after giving the queue back, at the highest of the work still pending.
+ */
+@interface TOAggregatingExecutor : NSObject <TOExecutor>
+
+/**
+ *  The executor that drains are given to, wrapping the queue. (read-only)
+ */
+@property (nonatomic, readonly) id<TOExecutor> executor;
+
+/**
+ *  The shared instance for the given GCD queue, the same one for as long as any observation uses it. The queue
+ *  should be serial, since all work given to the instance is run one item at a time by its drain.
+ */
++ (instancetype)executorForQueue:(dispatch_queue_t)queue;
+
+/**
+ *  The shared instance for the given operation queue, the same one for as long as any observation uses it. The
+ *  queue should be serial, with a `maxConcurrentOperationCount` of 1, as for `executorForQueue:`.
+ */
++ (instancetype)executorForOperationQueue:(NSOperationQueue *)operationQueue;
+
+/**
+ *  Initializes and returns an executor with its own pending list, separate from the shared instances.
+ *
+ *  @param executor A serial executor, such as a `TOGCDQueueExecutor` for a serial queue, that drains are given to.
+ */
+- (instancetype)initWithExecutor:(id<TOExecutor>)executor NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
+#undef TO_nullable
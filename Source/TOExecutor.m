@@ -0,0 +1,1223 @@
+//
+//  TOExecutor.m
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOExecutor.h"
+#import "TOExecutor+Private.h"
+#import <pthread.h>
+#import <pthread/qos.h>
+#import <stdatomic.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#else
+#define nullable
+#endif
+
+static void TORunBlock(void *context)
+{
+    dispatch_block_t block = (__bridge_transfer dispatch_block_t)context;
+    block();
+}
+
+qos_class_t TOQOSClassFromQualityOfService(NSQualityOfService qualityOfService)
+{
+    switch (qualityOfService) {
+        case NSQualityOfServiceUserInteractive: return QOS_CLASS_USER_INTERACTIVE;
+        case NSQualityOfServiceUserInitiated:   return QOS_CLASS_USER_INITIATED;
+        case NSQualityOfServiceUtility:         return QOS_CLASS_UTILITY;
+        case NSQualityOfServiceBackground:      return QOS_CLASS_BACKGROUND;
+        default:                                return QOS_CLASS_UNSPECIFIED;
+    }
+}
+
+static NSOperationQueuePriority TOQueuePriorityFromQualityOfService(NSQualityOfService qualityOfService)
+{
+    switch (qualityOfService) {
+        case NSQualityOfServiceUserInteractive: return NSOperationQueuePriorityVeryHigh;
+        case NSQualityOfServiceUserInitiated:   return NSOperationQueuePriorityHigh;
+        case NSQualityOfServiceUtility:         return NSOperationQueuePriorityLow;
+        case NSQualityOfServiceBackground:      return NSOperationQueuePriorityVeryLow;
+        default:                                return NSOperationQueuePriorityNormal;
+    }
+}
+
+
+#pragma mark -
+
+@implementation TOInlineExecutor
+
++ (instancetype)sharedExecutor
+{
+    static TOInlineExecutor *sharedExecutor;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedExecutor = [[self alloc] init];
+    });
+    return sharedExecutor;
+}
+
+- (void)executeBlock:(dispatch_block_t)block
+{
+    block();
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context
+{
+    function(context);
+}
+
+@end
+
+
+#pragma mark -
+
+@implementation TOGCDQueueExecutor
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue
+{
+    if (!(self = [super init]))
+        return nil;
+    _queue = queue;
+    return self;
+}
+
+- (void)executeBlock:(dispatch_block_t)block
+{
+    dispatch_async(self.queue, block);
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context
+{
+    dispatch_async_f(self.queue, context, function);
+}
+
+- (void)executeBlock:(dispatch_block_t)block qualityOfService:(NSQualityOfService)qualityOfService
+{
+    qos_class_t qos = TOQOSClassFromQualityOfService(qualityOfService);
+    if (qos == QOS_CLASS_UNSPECIFIED)
+        dispatch_async(self.queue, block);
+    else
+        dispatch_async(self.queue, dispatch_block_create_with_qos_class(DISPATCH_BLOCK_ENFORCE_QOS_CLASS, qos, 0, block));
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context qualityOfService:(NSQualityOfService)qualityOfService
+{
+    if (TOQOSClassFromQualityOfService(qualityOfService) == QOS_CLASS_UNSPECIFIED)
+        dispatch_async_f(self.queue, context, function);
+    else
+        [self executeBlock:^{ function(context); } qualityOfService:qualityOfService];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ %p: q=%s>", NSStringFromClass([self class]), self, dispatch_queue_get_label(self.queue)];
+}
+
+@end
+
+
+#pragma mark -
+
+static const int TOTargetQueueKeyVar;
+static void *TOTargetQueueKey = (void *)&TOTargetQueueKeyVar; // each tagged queue's value is the queue itself, unretained
+
+@implementation TOTargetQueueExecutor
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue
+{
+    if (!(self = [super initWithQueue:queue]))
+        return nil;
+    dispatch_queue_set_specific(queue, TOTargetQueueKey, (__bridge void *)queue, NULL);
+    return self;
+}
+
+- (BOOL)isOnQueue
+{
+    // also finds the tag when running on a queue that targets this one, which is equally safe to run inline on
+    return dispatch_get_specific(TOTargetQueueKey) == (__bridge void *)self.queue;
+}
+
+- (void)executeBlock:(dispatch_block_t)block
+{
+    if ([self isOnQueue])
+        block();
+    else
+        [super executeBlock:block];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context
+{
+    if ([self isOnQueue])
+        function(context);
+    else
+        [super executeFunction:function context:context];
+}
+
+- (void)executeBlock:(dispatch_block_t)block qualityOfService:(NSQualityOfService)qualityOfService
+{
+    if ([self isOnQueue])
+        block();
+    else
+        [super executeBlock:block qualityOfService:qualityOfService];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context qualityOfService:(NSQualityOfService)qualityOfService
+{
+    if ([self isOnQueue])
+        function(context);
+    else
+        [super executeFunction:function context:context qualityOfService:qualityOfService];
+}
+
+@end
+
+
+#pragma mark -
+
+@implementation TOOperationQueueExecutor
+
+- (instancetype)initWithOperationQueue:(NSOperationQueue *)operationQueue
+{
+    if (!(self = [super init]))
+        return nil;
+    _operationQueue = operationQueue;
+    return self;
+}
+
+- (void)executeBlock:(dispatch_block_t)block
+{
+    [self.operationQueue addOperationWithBlock:block];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context
+{
+    [self.operationQueue addOperationWithBlock:^{
+        function(context);
+    }];
+}
+
+- (void)executeBlock:(dispatch_block_t)block qualityOfService:(NSQualityOfService)qualityOfService
+{
+    if (qualityOfService == NSQualityOfServiceDefault) {
+        [self.operationQueue addOperationWithBlock:block];
+        return;
+    }
+    NSBlockOperation *operation = [NSBlockOperation blockOperationWithBlock:block];
+    operation.qualityOfService = qualityOfService;
+    operation.queuePriority = TOQueuePriorityFromQualityOfService(qualityOfService);
+    [self.operationQueue addOperation:operation];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context qualityOfService:(NSQualityOfService)qualityOfService
+{
+    [self executeBlock:^{ function(context); } qualityOfService:qualityOfService];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ %p: q=%@>", NSStringFromClass([self class]), self, self.operationQueue];
+}
+
+@end
+
+
+#pragma mark -
+
+typedef struct {
+    dispatch_function_t function;
+    void *context;
+    qos_class_t qos; // what the running thread switches to first, unless unspecified
+} TOWorkItem;
+
+static void TORunWorkItem(TOWorkItem item)
+{
+    // threads keep the last quality of service they switched to, so runs of work given the same one switch just once
+    if (item.qos != QOS_CLASS_UNSPECIFIED && item.qos != qos_class_self())
+        pthread_set_qos_class_self_np(item.qos, 0);
+    item.function(item.context);
+}
+
+// the quality of service given, otherwise that of the caller, which is what GCD would do
+static qos_class_t TOQOSClassForWork(NSQualityOfService qualityOfService)
+{
+    qos_class_t qos = TOQOSClassFromQualityOfService(qualityOfService);
+    return qos != QOS_CLASS_UNSPECIFIED ? qos : qos_class_self();
+}
+
+// growable ring buffer of work items, which in steady state adds and takes items without allocating
+typedef struct {
+    TOWorkItem *items;
+    NSUInteger capacity; // always a power of 2
+    NSUInteger head;
+    NSUInteger count;
+} TOWorkRing;
+
+static void TOWorkRingInit(TOWorkRing *ring)
+{
+    ring->capacity = 64;
+    ring->items = malloc(ring->capacity * sizeof(TOWorkItem));
+    ring->head = 0;
+    ring->count = 0;
+}
+
+static void TOWorkRingDestroy(TOWorkRing *ring)
+{
+    free(ring->items);
+    ring->items = NULL;
+}
+
+static void TOWorkRingGrowIfFull(TOWorkRing *ring)
+{
+    if (ring->count < ring->capacity)
+        return;
+    // unwrap the ring into the start of a buffer twice the size
+    TOWorkItem *items = malloc(ring->capacity * 2 * sizeof(TOWorkItem));
+    for (NSUInteger i = 0; i < ring->count; ++i) {
+        items[i] = ring->items[(ring->head + i) & (ring->capacity - 1)];
+    }
+    free(ring->items);
+    ring->items = items;
+    ring->capacity *= 2;
+    ring->head = 0;
+}
+
+static void TOWorkRingPushBack(TOWorkRing *ring, TOWorkItem item)
+{
+    TOWorkRingGrowIfFull(ring);
+    ring->items[(ring->head + ring->count) & (ring->capacity - 1)] = item;
+    ++ring->count;
+}
+
+static void TOWorkRingPushFront(TOWorkRing *ring, TOWorkItem item)
+{
+    TOWorkRingGrowIfFull(ring);
+    ring->head = (ring->head - 1) & (ring->capacity - 1);
+    ring->items[ring->head] = item;
+    ++ring->count;
+}
+
+static BOOL TOWorkRingPopFront(TOWorkRing *ring, TOWorkItem *item)
+{
+    if (ring->count == 0)
+        return NO;
+    *item = ring->items[ring->head];
+    ring->head = (ring->head + 1) & (ring->capacity - 1);
+    --ring->count;
+    return YES;
+}
+
+static BOOL TOWorkRingPopBack(TOWorkRing *ring, TOWorkItem *item)
+{
+    if (ring->count == 0)
+        return NO;
+    --ring->count;
+    *item = ring->items[(ring->head + ring->count) & (ring->capacity - 1)];
+    return YES;
+}
+
+/**
+ *  The state shared by a thread pool executor's threads, kept apart from the executor so that the threads don't
+ *  keep it alive.
+ */
+@interface TOThreadPoolWorkQueue : NSObject
+- (void)addFunction:(dispatch_function_t)function context:(nullable void *)context qos:(qos_class_t)qos;
+- (void)shutDown;
+- (void)runWorker;
+@end
+
+@implementation TOThreadPoolWorkQueue {
+    pthread_mutex_t _mutex;
+    pthread_cond_t _condition;
+    TOWorkRing _ring;
+    BOOL _shuttingDown;
+}
+
+- (instancetype)init
+{
+    if (!(self = [super init]))
+        return nil;
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_condition, NULL);
+    TOWorkRingInit(&_ring);
+    return self;
+}
+
+- (void)dealloc
+{
+    pthread_mutex_destroy(&_mutex);
+    pthread_cond_destroy(&_condition);
+    TOWorkRingDestroy(&_ring);
+}
+
+- (void)addFunction:(dispatch_function_t)function context:(nullable void *)context qos:(qos_class_t)qos
+{
+    pthread_mutex_lock(&_mutex);
+    TOWorkRingPushBack(&_ring, (TOWorkItem){ function, context, qos });
+    pthread_cond_signal(&_condition);
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (void)shutDown
+{
+    pthread_mutex_lock(&_mutex);
+    _shuttingDown = YES;
+    pthread_cond_broadcast(&_condition);
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (void)runWorker
+{
+    for (;;) {
+        TOWorkItem item;
+        pthread_mutex_lock(&_mutex);
+        while (_ring.count == 0 && !_shuttingDown) {
+            pthread_cond_wait(&_condition, &_mutex);
+        }
+        if (!TOWorkRingPopFront(&_ring, &item)) {
+            pthread_mutex_unlock(&_mutex);
+            return; // shutting down and nothing left to do
+        }
+        pthread_mutex_unlock(&_mutex);
+        
+        @autoreleasepool {
+            TORunWorkItem(item);
+        }
+    }
+}
+
+@end
+
+static void *TOThreadPoolWorkerMain(void *argument)
+{
+    TOThreadPoolWorkQueue *workQueue = (__bridge_transfer TOThreadPoolWorkQueue *)argument;
+    [workQueue runWorker];
+    return NULL;
+}
+
+
+@interface TOThreadPoolExecutor ()
+@property (nonatomic) TOThreadPoolWorkQueue *workQueue;
+@end
+
+@implementation TOThreadPoolExecutor
+
+- (instancetype)initWithThreadCount:(NSUInteger)threadCount
+{
+    NSParameterAssert(threadCount > 0);
+    if (!(self = [super init]))
+        return nil;
+    _threadCount = threadCount;
+    _workQueue = [[TOThreadPoolWorkQueue alloc] init];
+    for (NSUInteger i = 0; i < threadCount; ++i) {
+        pthread_t thread;
+        void *argument = (__bridge_retained void *)_workQueue;
+        if (pthread_create(&thread, NULL, TOThreadPoolWorkerMain, argument) != 0) {
+            CFRelease(argument);
+            [NSException raise:NSInternalInconsistencyException format:@"Could not create thread for %@", self];
+        }
+        pthread_detach(thread);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_workQueue shutDown];
+}
+
+- (void)executeBlock:(dispatch_block_t)block
+{
+    [self executeBlock:block qualityOfService:NSQualityOfServiceDefault];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context
+{
+    [self executeFunction:function context:context qualityOfService:NSQualityOfServiceDefault];
+}
+
+- (void)executeBlock:(dispatch_block_t)block qualityOfService:(NSQualityOfService)qualityOfService
+{
+    [self executeFunction:TORunBlock context:(__bridge_retained void *)[block copy] qualityOfService:qualityOfService];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context qualityOfService:(NSQualityOfService)qualityOfService
+{
+    [self.workQueue addFunction:function context:context qos:TOQOSClassForWork(qualityOfService)];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ %p: threads=%lu>", NSStringFromClass([self class]), self, (unsigned long)self.threadCount];
+}
+
+@end
+
+
+#pragma mark -
+
+#define TO_LANE_QUANTUM 16 // items a lane runs before letting the worker get to other lanes
+
+// a worker's deque, the worker takes from the back while idle workers steal from the front
+typedef struct {
+    pthread_mutex_t mutex;
+    TOWorkRing ring;
+    const void *pool; // the state object of the pool this deque belongs to, unretained
+} TOWorkDeque;
+
+static pthread_key_t TOCurrentWorkDequeKey(void)
+{
+    static pthread_key_t currentWorkDequeKey; // deque of the work-stealing worker running on the thread
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&currentWorkDequeKey, NULL);
+    });
+    return currentWorkDequeKey;
+}
+
+/**
+ *  The state shared by a work-stealing executor's threads, kept apart from the executor so that the threads don't
+ *  keep it alive.
+ */
+@interface TOWorkStealingPool : NSObject
+- (instancetype)initWithThreadCount:(NSUInteger)threadCount;
+- (void)addFunction:(dispatch_function_t)function context:(nullable void *)context qos:(qos_class_t)qos;
+- (void)requeueFunction:(dispatch_function_t)function context:(nullable void *)context;
+- (void)shutDown;
+- (void)runWorkerAtIndex:(NSUInteger)index;
+@end
+
+@implementation TOWorkStealingPool {
+    NSUInteger _threadCount;
+    TOWorkDeque *_deques;
+    _Atomic(NSUInteger) _nextDeque;    // where work from outside the pool goes next, round-robin
+    _Atomic(NSUInteger) _pendingCount; // at least the number of items in all deques, incremented before adding one
+    _Atomic(NSUInteger) _sleeperCount;
+    pthread_mutex_t _idleMutex;
+    pthread_cond_t _idleCondition;
+    BOOL _shuttingDown; // guarded by _idleMutex
+}
+
+- (instancetype)initWithThreadCount:(NSUInteger)threadCount
+{
+    if (!(self = [super init]))
+        return nil;
+    _threadCount = threadCount;
+    _deques = calloc(threadCount, sizeof(TOWorkDeque));
+    for (NSUInteger i = 0; i < threadCount; ++i) {
+        pthread_mutex_init(&_deques[i].mutex, NULL);
+        TOWorkRingInit(&_deques[i].ring);
+        _deques[i].pool = (__bridge const void *)self;
+    }
+    pthread_mutex_init(&_idleMutex, NULL);
+    pthread_cond_init(&_idleCondition, NULL);
+    return self;
+}
+
+- (void)dealloc
+{
+    for (NSUInteger i = 0; i < _threadCount; ++i) {
+        pthread_mutex_destroy(&_deques[i].mutex);
+        TOWorkRingDestroy(&_deques[i].ring);
+    }
+    free(_deques);
+    pthread_mutex_destroy(&_idleMutex);
+    pthread_cond_destroy(&_idleCondition);
+}
+
+- (nullable TOWorkDeque *)currentWorkerDeque
+{
+    TOWorkDeque *deque = pthread_getspecific(TOCurrentWorkDequeKey());
+    return (deque != NULL && deque->pool == (__bridge const void *)self) ? deque : NULL;
+}
+
+- (void)addFunction:(dispatch_function_t)function context:(nullable void *)context qos:(qos_class_t)qos
+{
+    // work added by a worker stays with it, to be stolen by others only if they run out
+    TOWorkDeque *deque = [self currentWorkerDeque];
+    if (deque == NULL)
+        deque = &_deques[atomic_fetch_add(&_nextDeque, 1) % _threadCount];
+    
+    atomic_fetch_add(&_pendingCount, 1);
+    pthread_mutex_lock(&deque->mutex);
+    TOWorkRingPushBack(&deque->ring, (TOWorkItem){ function, context, qos });
+    pthread_mutex_unlock(&deque->mutex);
+    [self wakeSleeper];
+}
+
+- (void)requeueFunction:(dispatch_function_t)function context:(nullable void *)context
+{
+    // to the end of the worker's deque that it takes from last, behind everything else it has waiting
+    TOWorkDeque *deque = [self currentWorkerDeque];
+    NSAssert(deque != NULL, @"Requeueing work from outside of the pool's workers");
+    
+    atomic_fetch_add(&_pendingCount, 1);
+    pthread_mutex_lock(&deque->mutex);
+    TOWorkRingPushFront(&deque->ring, (TOWorkItem){ function, context, QOS_CLASS_UNSPECIFIED });
+    pthread_mutex_unlock(&deque->mutex);
+    [self wakeSleeper];
+}
+
+- (void)wakeSleeper
+{
+    // a worker only waits after checking _pendingCount with _idleMutex held, so it either sees the new item or this
+    // sees it as a sleeper
+    if (atomic_load(&_sleeperCount) == 0)
+        return;
+    pthread_mutex_lock(&_idleMutex);
+    pthread_cond_signal(&_idleCondition);
+    pthread_mutex_unlock(&_idleMutex);
+}
+
+- (BOOL)takeWorkForWorkerAtIndex:(NSUInteger)index item:(TOWorkItem *)item
+{
+    TOWorkDeque *own = &_deques[index];
+    pthread_mutex_lock(&own->mutex);
+    BOOL found = TOWorkRingPopBack(&own->ring, item);
+    pthread_mutex_unlock(&own->mutex);
+    
+    for (NSUInteger i = 1; !found && i < _threadCount; ++i) {
+        TOWorkDeque *victim = &_deques[(index + i) % _threadCount];
+        pthread_mutex_lock(&victim->mutex);
+        found = TOWorkRingPopFront(&victim->ring, item);
+        pthread_mutex_unlock(&victim->mutex);
+    }
+    
+    if (found)
+        atomic_fetch_sub(&_pendingCount, 1);
+    return found;
+}
+
+- (void)shutDown
+{
+    pthread_mutex_lock(&_idleMutex);
+    _shuttingDown = YES;
+    pthread_cond_broadcast(&_idleCondition);
+    pthread_mutex_unlock(&_idleMutex);
+}
+
+- (void)runWorkerAtIndex:(NSUInteger)index
+{
+    pthread_setspecific(TOCurrentWorkDequeKey(), &_deques[index]);
+    for (;;) {
+        TOWorkItem item;
+        if ([self takeWorkForWorkerAtIndex:index item:&item]) {
+            @autoreleasepool {
+                TORunWorkItem(item);
+            }
+            continue;
+        }
+        
+        pthread_mutex_lock(&_idleMutex);
+        atomic_fetch_add(&_sleeperCount, 1);
+        while (atomic_load(&_pendingCount) == 0 && !_shuttingDown) {
+            pthread_cond_wait(&_idleCondition, &_idleMutex);
+        }
+        atomic_fetch_sub(&_sleeperCount, 1);
+        BOOL finished = _shuttingDown && atomic_load(&_pendingCount) == 0;
+        pthread_mutex_unlock(&_idleMutex);
+        if (finished)
+            break;
+    }
+    pthread_setspecific(TOCurrentWorkDequeKey(), NULL);
+}
+
+@end
+
+typedef struct {
+    void *pool; // retained
+    NSUInteger index;
+} TOWorkStealingWorkerArgument;
+
+static void *TOWorkStealingWorkerMain(void *argument)
+{
+    TOWorkStealingWorkerArgument *workerArgument = argument;
+    TOWorkStealingPool *pool = (__bridge_transfer TOWorkStealingPool *)workerArgument->pool;
+    NSUInteger index = workerArgument->index;
+    free(workerArgument);
+    [pool runWorkerAtIndex:index];
+    return NULL;
+}
+
+
+/**
+ *  A serial executor feeding a work-stealing executor's pool. Only one worker at a time runs a lane's items, in the
+ *  order they were added, while separate lanes are spread across workers.
+ */
+@interface TOWorkStealingLane : NSObject <TOExecutor>
+- (instancetype)initWithExecutor:(TOWorkStealingExecutor *)executor pool:(TOWorkStealingPool *)pool;
+- (void)runQuantum;
+@end
+
+static void TORunLaneQuantum(void *context)
+{
+    TOWorkStealingLane *lane = (__bridge_transfer TOWorkStealingLane *)context;
+    [lane runQuantum];
+}
+
+@implementation TOWorkStealingLane {
+    TOWorkStealingExecutor *_executor; // keeps the pool's threads running while the lane can be given work
+    TOWorkStealingPool *_pool;
+    pthread_mutex_t _mutex;
+    TOWorkRing _ring;
+    BOOL _scheduled; // in a deque or being run by a worker, guarded by _mutex
+}
+
+- (instancetype)initWithExecutor:(TOWorkStealingExecutor *)executor pool:(TOWorkStealingPool *)pool
+{
+    if (!(self = [super init]))
+        return nil;
+    _executor = executor;
+    _pool = pool;
+    pthread_mutex_init(&_mutex, NULL);
+    TOWorkRingInit(&_ring);
+    return self;
+}
+
+- (void)dealloc
+{
+    pthread_mutex_destroy(&_mutex);
+    TOWorkRingDestroy(&_ring);
+}
+
+- (void)executeBlock:(dispatch_block_t)block
+{
+    [self executeBlock:block qualityOfService:NSQualityOfServiceDefault];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context
+{
+    [self executeFunction:function context:context qualityOfService:NSQualityOfServiceDefault];
+}
+
+- (void)executeBlock:(dispatch_block_t)block qualityOfService:(NSQualityOfService)qualityOfService
+{
+    [self executeFunction:TORunBlock context:(__bridge_retained void *)[block copy] qualityOfService:qualityOfService];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context qualityOfService:(NSQualityOfService)qualityOfService
+{
+    pthread_mutex_lock(&_mutex);
+    TOWorkRingPushBack(&_ring, (TOWorkItem){ function, context, TOQOSClassForWork(qualityOfService) });
+    BOOL schedule = !_scheduled;
+    _scheduled = YES;
+    pthread_mutex_unlock(&_mutex);
+    
+    // each item switches to its own quality of service as it's run, so the quantum itself doesn't
+    if (schedule)
+        [_pool addFunction:TORunLaneQuantum context:(__bridge_retained void *)self qos:QOS_CLASS_UNSPECIFIED];
+}
+
+- (void)runQuantum
+{
+    for (NSUInteger i = 0; i < TO_LANE_QUANTUM; ++i) {
+        TOWorkItem item;
+        pthread_mutex_lock(&_mutex);
+        if (!TOWorkRingPopFront(&_ring, &item)) {
+            _scheduled = NO;
+            pthread_mutex_unlock(&_mutex);
+            return;
+        }
+        pthread_mutex_unlock(&_mutex);
+        TORunWorkItem(item);
+    }
+    
+    pthread_mutex_lock(&_mutex);
+    BOOL more = _ring.count > 0;
+    if (!more)
+        _scheduled = NO;
+    pthread_mutex_unlock(&_mutex);
+    
+    if (more)
+        [_pool requeueFunction:TORunLaneQuantum context:(__bridge_retained void *)self];
+}
+
+@end
+
+
+@interface TOWorkStealingExecutor ()
+@property (nonatomic) TOWorkStealingPool *pool;
+@end
+
+@implementation TOWorkStealingExecutor
+
+- (instancetype)init
+{
+    return [self initWithThreadCount:[NSProcessInfo processInfo].activeProcessorCount];
+}
+
+- (instancetype)initWithThreadCount:(NSUInteger)threadCount
+{
+    NSParameterAssert(threadCount > 0);
+    if (!(self = [super init]))
+        return nil;
+    _threadCount = threadCount;
+    _pool = [[TOWorkStealingPool alloc] initWithThreadCount:threadCount];
+    for (NSUInteger i = 0; i < threadCount; ++i) {
+        pthread_t thread;
+        TOWorkStealingWorkerArgument *argument = malloc(sizeof(TOWorkStealingWorkerArgument));
+        argument->pool = (__bridge_retained void *)_pool;
+        argument->index = i;
+        if (pthread_create(&thread, NULL, TOWorkStealingWorkerMain, argument) != 0) {
+            CFRelease(argument->pool);
+            free(argument);
+            [NSException raise:NSInternalInconsistencyException format:@"Could not create thread for %@", self];
+        }
+        pthread_detach(thread);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_pool shutDown];
+}
+
+- (id<TOExecutor>)serialExecutor
+{
+    return [[TOWorkStealingLane alloc] initWithExecutor:self pool:self.pool];
+}
+
+- (void)executeBlock:(dispatch_block_t)block
+{
+    [self executeBlock:block qualityOfService:NSQualityOfServiceDefault];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context
+{
+    [self executeFunction:function context:context qualityOfService:NSQualityOfServiceDefault];
+}
+
+- (void)executeBlock:(dispatch_block_t)block qualityOfService:(NSQualityOfService)qualityOfService
+{
+    [self executeFunction:TORunBlock context:(__bridge_retained void *)[block copy] qualityOfService:qualityOfService];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context qualityOfService:(NSQualityOfService)qualityOfService
+{
+    [self.pool addFunction:function context:context qos:TOQOSClassForWork(qualityOfService)];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ %p: threads=%lu>", NSStringFromClass([self class]), self, (unsigned long)self.threadCount];
+}
+
+@end
+
+
+
+#pragma mark -
+
+@implementation TOShardedExecutor {
+    NSArray<TOGCDQueueExecutor *> *_shards;
+}
+
++ (instancetype)sharedExecutor
+{
+    static TOShardedExecutor *sharedExecutor;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedExecutor = [[self alloc] init];
+    });
+    return sharedExecutor;
+}
+
+- (instancetype)init
+{
+    return [self initWithShardCount:[NSProcessInfo processInfo].activeProcessorCount];
+}
+
+- (instancetype)initWithShardCount:(NSUInteger)shardCount
+{
+    NSParameterAssert(shardCount > 0);
+    if (!(self = [super init]))
+        return nil;
+    _shardCount = shardCount;
+    NSMutableArray *shards = [NSMutableArray arrayWithCapacity:shardCount];
+    for (NSUInteger i = 0; i < shardCount; ++i) {
+        NSString *label = [NSString stringWithFormat:@"TotalObserver shard %lu", (unsigned long)i];
+        dispatch_queue_t queue = dispatch_queue_create(label.UTF8String, DISPATCH_QUEUE_SERIAL);
+        [shards addObject:[[TOGCDQueueExecutor alloc] initWithQueue:queue]];
+    }
+    _shards = [shards copy];
+    return self;
+}
+
+- (id<TOExecutor>)executorForKey:(const void *)key
+{
+    // low bits of object pointers are always 0, mix in higher ones so neighbouring allocations spread out
+    uintptr_t bits = (uintptr_t)key;
+    return _shards[((bits >> 4) ^ (bits >> 12)) % _shardCount];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ %p: shards=%lu>", NSStringFromClass([self class]), self, (unsigned long)self.shardCount];
+}
+
+@end
+
+
+#pragma mark -
+
+#define TO_FAIR_DRAIN_QUANTUM 64 // items a drain runs before giving the queue back to other work
+
+@class TOFairQueueFlow;
+
+@interface TOFairQueueScheduler ()
+- (void)activateFlow:(TOFairQueueFlow *)flow qualityOfService:(NSQualityOfService)qualityOfService;
+- (void)drain;
+@end
+
+/**
+ *  An observation's own pending work, run by a fair queue scheduler's drain in turns with other flows.
+ */
+@interface TOFairQueueFlow : NSObject <TOExecutor>
+- (instancetype)initWithScheduler:(TOFairQueueScheduler *)scheduler weight:(NSUInteger)weight;
+- (NSUInteger)runTurn;
+@end
+
+static void TODrainFairQueue(void *context)
+{
+    TOFairQueueScheduler *scheduler = (__bridge_transfer TOFairQueueScheduler *)context;
+    [scheduler drain];
+}
+
+@implementation TOFairQueueFlow {
+    TOFairQueueScheduler *_scheduler;
+    NSUInteger _weight;
+    pthread_mutex_t _mutex;
+    TOWorkRing _ring;
+    BOOL _active; // in the scheduler's turns or running one, guarded by _mutex
+    NSQualityOfService _pendingQualityOfService; // highest given for the work in _ring, guarded by _mutex
+}
+
+- (instancetype)initWithScheduler:(TOFairQueueScheduler *)scheduler weight:(NSUInteger)weight
+{
+    if (!(self = [super init]))
+        return nil;
+    _scheduler = scheduler;
+    _weight = weight;
+    pthread_mutex_init(&_mutex, NULL);
+    TOWorkRingInit(&_ring);
+    _pendingQualityOfService = NSQualityOfServiceDefault;
+    return self;
+}
+
+- (void)dealloc
+{
+    pthread_mutex_destroy(&_mutex);
+    TOWorkRingDestroy(&_ring);
+}
+
+- (void)executeBlock:(dispatch_block_t)block
+{
+    [self executeFunction:TORunBlock context:(__bridge_retained void *)[block copy]];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context
+{
+    [self executeFunction:function context:context qualityOfService:NSQualityOfServiceDefault];
+}
+
+- (void)executeBlock:(dispatch_block_t)block qualityOfService:(NSQualityOfService)qualityOfService
+{
+    [self executeFunction:TORunBlock context:(__bridge_retained void *)[block copy] qualityOfService:qualityOfService];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context qualityOfService:(NSQualityOfService)qualityOfService
+{
+    pthread_mutex_lock(&_mutex);
+    TOWorkRingPushBack(&_ring, (TOWorkItem){ function, context, QOS_CLASS_UNSPECIFIED });
+    if (qualityOfService > _pendingQualityOfService) // NSQualityOfServiceDefault is -1, below all the others
+        _pendingQualityOfService = qualityOfService;
+    NSQualityOfService pendingQualityOfService = _pendingQualityOfService;
+    BOOL activate = !_active;
+    _active = YES;
+    pthread_mutex_unlock(&_mutex);
+    
+    if (activate)
+        [_scheduler activateFlow:self qualityOfService:pendingQualityOfService];
+}
+
+- (NSUInteger)runTurn
+{
+    NSUInteger ran = 0;
+    while (ran < _weight) {
+        TOWorkItem item;
+        pthread_mutex_lock(&_mutex);
+        if (!TOWorkRingPopFront(&_ring, &item)) {
+            _active = NO;
+            _pendingQualityOfService = NSQualityOfServiceDefault;
+            pthread_mutex_unlock(&_mutex);
+            return ran;
+        }
+        pthread_mutex_unlock(&_mutex);
+        // not TORunWorkItem, GCD's threads mustn't have their quality of service changed directly
+        item.function(item.context);
+        ++ran;
+    }
+    
+    pthread_mutex_lock(&_mutex);
+    BOOL more = _ring.count > 0;
+    if (!more) {
+        _active = NO;
+        _pendingQualityOfService = NSQualityOfServiceDefault;
+    }
+    // may still count work this turn ran, since the ring doesn't keep each item's, so at worst the drain runs higher
+    NSQualityOfService pendingQualityOfService = _pendingQualityOfService;
+    pthread_mutex_unlock(&_mutex);
+    
+    if (more)
+        [_scheduler activateFlow:self qualityOfService:pendingQualityOfService]; // to the back of the turns
+    return ran;
+}
+
+@end
+
+
+@implementation TOFairQueueScheduler {
+    TOGCDQueueExecutor *_queueExecutor; // gives drains to the queue at a quality of service
+    pthread_mutex_t _mutex;
+    TOWorkRing _turns; // flows with work pending, each item's context a retained flow and its function unused
+    BOOL _drainScheduled; // guarded by _mutex
+    NSQualityOfService _pendingQualityOfService; // highest of flows activated since _turns was empty, guarded by _mutex
+}
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue
+{
+    if (!(self = [super init]))
+        return nil;
+    _queue = queue;
+    _queueExecutor = [[TOGCDQueueExecutor alloc] initWithQueue:queue];
+    pthread_mutex_init(&_mutex, NULL);
+    TOWorkRingInit(&_turns);
+    _pendingQualityOfService = NSQualityOfServiceDefault;
+    return self;
+}
+
+- (void)dealloc
+{
+    pthread_mutex_destroy(&_mutex);
+    TOWorkRingDestroy(&_turns); // empty, since a scheduled drain keeps the scheduler alive until it finishes them all
+}
+
+- (id<TOExecutor>)executorWithWeight:(NSUInteger)weight
+{
+    NSParameterAssert(weight > 0);
+    return [[TOFairQueueFlow alloc] initWithScheduler:self weight:weight];
+}
+
+- (void)activateFlow:(TOFairQueueFlow *)flow qualityOfService:(NSQualityOfService)qualityOfService
+{
+    pthread_mutex_lock(&_mutex);
+    TOWorkRingPushBack(&_turns, (TOWorkItem){ NULL, (__bridge_retained void *)flow, QOS_CLASS_UNSPECIFIED });
+    if (qualityOfService > _pendingQualityOfService)
+        _pendingQualityOfService = qualityOfService;
+    BOOL schedule = !_drainScheduled;
+    _drainScheduled = YES;
+    pthread_mutex_unlock(&_mutex);
+    
+    if (schedule)
+        [_queueExecutor executeFunction:TODrainFairQueue context:(__bridge_retained void *)self qualityOfService:qualityOfService];
+}
+
+- (void)drain
+{
+    NSUInteger ran = 0;
+    while (ran < TO_FAIR_DRAIN_QUANTUM) {
+        TOWorkItem turn;
+        pthread_mutex_lock(&_mutex);
+        if (!TOWorkRingPopFront(&_turns, &turn)) {
+            _drainScheduled = NO;
+            _pendingQualityOfService = NSQualityOfServiceDefault;
+            pthread_mutex_unlock(&_mutex);
+            return;
+        }
+        pthread_mutex_unlock(&_mutex);
+        
+        TOFairQueueFlow *flow = (__bridge_transfer TOFairQueueFlow *)turn.context;
+        ran += [flow runTurn];
+    }
+    
+    // still scheduled, continues behind whatever else was given to the queue meanwhile, at the quality of service of
+    // the most urgent flow activated since the turns were last empty
+    pthread_mutex_lock(&_mutex);
+    NSQualityOfService qualityOfService = _pendingQualityOfService;
+    pthread_mutex_unlock(&_mutex);
+    [_queueExecutor executeFunction:TODrainFairQueue context:(__bridge_retained void *)self qualityOfService:qualityOfService];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ %p: q=%s>", NSStringFromClass([self class]), self, dispatch_queue_get_label(self.queue)];
+}
+
+@end
+
+
+#pragma mark -
+
+#define TO_AGGREGATE_DRAIN_QUANTUM 1024 // items a drain runs before giving the queue back to other work
+
+static pthread_mutex_t sharedAggregatingExecutorsMutex = PTHREAD_MUTEX_INITIALIZER;
+static NSMapTable *sharedAggregatingExecutors; // keyed by queue pointer with weak values, guarded by the mutex above
+
+@interface TOAggregatingExecutor ()
+- (void)drain;
+@end
+
+static void TODrainAggregatingExecutor(void *context)
+{
+    TOAggregatingExecutor *executor = (__bridge_transfer TOAggregatingExecutor *)context;
+    [executor drain];
+}
+
+@implementation TOAggregatingExecutor {
+    pthread_mutex_t _mutex;
+    TOWorkRing _ring;
+    TOWorkRing _drainingRing; // only used by the drain, swapped with _ring to take everything pending at once
+    BOOL _drainScheduled;     // guarded by _mutex
+    NSQualityOfService _pendingQualityOfService; // highest given for the work in _ring, guarded by _mutex
+}
+
++ (instancetype)sharedExecutorForKey:(const void *)key creatingWith:(id<TOExecutor>(^)(void))createExecutor
+{
+    // a live executor keeps its queue alive, so the queue's address can't have been reused for another one
+    pthread_mutex_lock(&sharedAggregatingExecutorsMutex);
+    if (sharedAggregatingExecutors == nil)
+        sharedAggregatingExecutors = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality valueOptions:NSPointerFunctionsWeakMemory capacity:0];
+    TOAggregatingExecutor *executor = [sharedAggregatingExecutors objectForKey:(__bridge id)key];
+    if (executor == nil) {
+        executor = [[self alloc] initWithExecutor:createExecutor()];
+        [sharedAggregatingExecutors setObject:executor forKey:(__bridge id)key];
+    }
+    pthread_mutex_unlock(&sharedAggregatingExecutorsMutex);
+    return executor;
+}
+
++ (instancetype)executorForQueue:(dispatch_queue_t)queue
+{
+    return [self sharedExecutorForKey:(__bridge const void *)queue creatingWith:^id<TOExecutor>{
+        return [[TOGCDQueueExecutor alloc] initWithQueue:queue];
+    }];
+}
+
++ (instancetype)executorForOperationQueue:(NSOperationQueue *)operationQueue
+{
+    return [self sharedExecutorForKey:(__bridge const void *)operationQueue creatingWith:^id<TOExecutor>{
+        return [[TOOperationQueueExecutor alloc] initWithOperationQueue:operationQueue];
+    }];
+}
+
+- (instancetype)initWithExecutor:(id<TOExecutor>)executor
+{
+    if (!(self = [super init]))
+        return nil;
+    _executor = executor;
+    pthread_mutex_init(&_mutex, NULL);
+    TOWorkRingInit(&_ring);
+    TOWorkRingInit(&_drainingRing);
+    _pendingQualityOfService = NSQualityOfServiceDefault;
+    return self;
+}
+
+- (void)dealloc
+{
+    pthread_mutex_destroy(&_mutex);
+    TOWorkRingDestroy(&_ring); // empty, since a scheduled drain keeps the executor alive until it runs everything
+    TOWorkRingDestroy(&_drainingRing);
+}
+
+- (void)executeBlock:(dispatch_block_t)block
+{
+    [self executeFunction:TORunBlock context:(__bridge_retained void *)[block copy]];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context
+{
+    [self executeFunction:function context:context qualityOfService:NSQualityOfServiceDefault];
+}
+
+- (void)executeBlock:(dispatch_block_t)block qualityOfService:(NSQualityOfService)qualityOfService
+{
+    [self executeFunction:TORunBlock context:(__bridge_retained void *)[block copy] qualityOfService:qualityOfService];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context qualityOfService:(NSQualityOfService)qualityOfService
+{
+    pthread_mutex_lock(&_mutex);
+    TOWorkRingPushBack(&_ring, (TOWorkItem){ function, context, QOS_CLASS_UNSPECIFIED });
+    if (qualityOfService > _pendingQualityOfService) // NSQualityOfServiceDefault is -1, below all the others
+        _pendingQualityOfService = qualityOfService;
+    BOOL schedule = !_drainScheduled;
+    _drainScheduled = YES;
+    pthread_mutex_unlock(&_mutex);
+    
+    if (schedule)
+        [self scheduleDrainWithQualityOfService:qualityOfService];
+}
+
+- (void)scheduleDrainWithQualityOfService:(NSQualityOfService)qualityOfService
+{
+    id<TOExecutor> executor = self.executor;
+    void *context = (__bridge_retained void *)self;
+    if (qualityOfService != NSQualityOfServiceDefault && [executor respondsToSelector:@selector(executeFunction:context:qualityOfService:)])
+        [executor executeFunction:TODrainAggregatingExecutor context:context qualityOfService:qualityOfService];
+    else
+        [executor executeFunction:TODrainAggregatingExecutor context:context];
+}
+
+- (void)drain
+{
+    NSUInteger ran = 0;
+    NSQualityOfService qualityOfService;
+    for (;;) {
+        pthread_mutex_lock(&_mutex);
+        if (_ring.count == 0) {
+            _drainScheduled = NO;
+            pthread_mutex_unlock(&_mutex);
+            return;
+        }
+        if (ran >= TO_AGGREGATE_DRAIN_QUANTUM) {
+            qualityOfService = _pendingQualityOfService;
+            pthread_mutex_unlock(&_mutex);
+            break;
+        }
+        // take everything pending in one go, work given meanwhile goes to the emptied ring for the next pass
+        TOWorkRing pending = _ring;
+        _ring = _drainingRing;
+        _pendingQualityOfService = NSQualityOfServiceDefault;
+        pthread_mutex_unlock(&_mutex);
+        
+        TOWorkItem item;
+        while (TOWorkRingPopFront(&pending, &item)) {
+            // not TORunWorkItem, GCD's threads mustn't have their quality of service changed directly
+            item.function(item.context);
+            ++ran;
+        }
+        _drainingRing = pending;
+    }
+    
+    // still scheduled, continues behind whatever else was given to the queue meanwhile, at the quality of service of
+    // the most urgent work left rather than whatever the thread giving it back happens to be running at
+    [self scheduleDrainWithQualityOfService:qualityOfService];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ %p: executor=%@>", NSStringFromClass([self class]), self, self.executor];
+}
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#else
+#undef nullable
+#endif
@@ -27,6 +27,33 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)register;
 @end
 
+@interface TOObservation (PrivateForBagToUse)
+/**
+ *  The key the observation is indexed by in the observer's and observee's registries, `nil` until calculated by
+ *  `prepareIndexKey` or if the observation's `hashKey` is `nil`.
+ */
+- (TO_nullable NSString *)indexKey;
+
+/**
+ *  Calculate `indexKey`, which must be done before the observation is stored into its observer and observee. Done
+ *  as part of `register` unless storing was deferred to a bag.
+ */
+- (void)prepareIndexKey;
+
+/**
+ *  Arrange for automatic removal according to `automaticRemovalMode`, which must be done after the observation is
+ *  stored into its observer and observee. Done as part of `register` unless storing was deferred to a bag.
+ */
+- (void)adoptAutomaticRemoval;
+
+/**
+ *  Everything `remove` does other than removing the observation from its observer's and observee's registries,
+ *  calling `deregisterInternal`, setting `registered` to `NO`, dropping deliveries still waiting and stopping the
+ *  watchdog. Used by a bag when it removes observations from the registries itself.
+ */
+- (void)deregisterForRemoval;
+@end
+
 @interface TOObservation (PrivateForSubclassesToUse)
 
 /**
@@ -72,6 +99,44 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (instancetype)initWithObject:(TO_nullable id)object queue:(TO_nullable NSOperationQueue *)queue gcdQueue:(TO_nullable dispatch_queue_t)cgdQueue block:(TO_nullable TOAnonymousObservationBlock)block;
 
+/**
+ *  Initializes and returns a newly allocated observation object with an observer, delivering through the given
+ *  executor. A designated initializer, don't call plain `init`.
+ *
+ *  Parameters are the same as for `initWithObserver:object:queue:gcdQueue:block:`, except that `executor` is used
+ *  as is instead of one made for a queue.
+ *
+ *  @return An initialized TOObservation object.
+ */
+- (instancetype)initWithObserver:(TO_nullable id)observer object:(TO_nullable id)object executor:(TO_nullable id<TOExecutor>)executor block:(TO_nullable TOObservationBlock)block;
+
+/**
+ *  Initializes and returns a newly allocated observation object with no observer, delivering through the given
+ *  executor. A designated initializer, don't call plain `init`.
+ *
+ *  Parameters are the same as for `initWithObject:queue:gcdQueue:block:`, except that `executor` is used as is
+ *  instead of one made for a queue.
+ *
+ *  @return An initialized TOObservation object.
+ */
+- (instancetype)initWithObject:(TO_nullable id)object executor:(TO_nullable id<TOExecutor>)executor block:(TO_nullable TOAnonymousObservationBlock)block;
+
+/**
+ *  Initializes and returns a newly allocated observation object with an observer and a batch block. A designated
+ *  initializer, don't call plain `init`.
+ *
+ *  Parameters are the same as for `initWithObserver:object:queue:gcdQueue:block:`, except for the block which will
+ *  be called with an array of copies made by `eventCopy` and set up by `invokeOnQueueForEvent:`.
+ *
+ *  @return An initialized TOObservation object.
+ */
+- (instancetype)initWithObserver:(TO_nullable id)observer object:(TO_nullable id)object queue:(TO_nullable NSOperationQueue *)queue gcdQueue:(TO_nullable dispatch_queue_t)cgdQueue batchBlock:(TO_nullable TOCollatedObservationBlock)block;
+
+/**
+ *  Normally subclasses don't need to set this, except on the copies they return from `eventCopy`.
+ */
+@property (nonatomic, readwrite, weak, TO_nullable) TOObservation *sourceObservation;
+
 
 /**
  *  Cause the observation block to be called synchronously.
@@ -105,6 +170,33 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)invokeOnQueueAfter:(void(^)(void))setup by:(void(^)(void))invoke;
 
+/**
+ *  Cause the observation block to be called on the correct queue for a trigger described by `setup`, used instead
+ *  of `invokeOnQueueAfter:` by subclasses which override `eventCopy`.
+ *
+ *  If `setup` is passed a copy of the receiver it's called synchronously before this method returns, and the copy
+ *  carries the trigger to the queue, where it's passed to the block if `deliversEventCopies` is `YES` or otherwise
+ *  passed to `takeEventFromCopy:`. Copies are made for batches, for event copies, and when delivering to a queue
+ *  without coalescing. Otherwise `setup` is passed the receiver itself and is called just as with
+ *  `invokeOnQueueAfter:`.
+ *
+ *  @param setup A block which sets the properties of the observation it's passed to describe the trigger.
+ */
+- (void)invokeOnQueueForEvent:(void(^)(id observation))setup;
+
+/**
+ *  Cause the observation block to be called synchronously for a trigger described by `setup`. Use this instead of
+ *  `invokeOnQueueForEvent:` from code you know is running on the correct queue, when `batchBlock` is `nil`.
+ *
+ *  If `deliversEventCopies` is `YES`, `setup` is passed an idle copy of the receiver, reused from an earlier trigger
+ *  when one's available and otherwise made by `eventCopy`, and the block is passed that copy, which is kept to be
+ *  reused again afterwards. Otherwise `setup` is passed the receiver itself. Either way the trigger is subject to
+ *  `rateLimit` first.
+ *
+ *  @param setup See `invokeOnQueueForEvent:`
+ */
+- (void)invokeForEvent:(void(^)(id observation))setup;
+
 
 /**
  *  Look-up an observation based on the same parameters used in its creation.
@@ -118,6 +210,21 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (TOObservation *)findObservationForObserver:(TO_nullable id)observer object:(TO_nullable id)object matchingTest:(BOOL(^)(TOObservation *observation))testBlock;
 
+/**
+ *  Look-up an observation based on the same parameters used in its creation, using the index of observations
+ *  stored in the observer or observee. Only observations whose `hashKey` equals the given key are candidates,
+ *  so the cost doesn't grow with the number of other observations that object holds.
+ *
+ *  @param observer  The observer object, or `nil` if not applicable.
+ *  @param object    The object being observed, if applicable.
+ *  @param hashKey   The key the matching observation returns from `hashKey`.
+ *  @param testBlock An optional block to be called to compare additional properties of the observation, will only
+ *                   be called with observations whose observer, observee and hash key values match.
+ *
+ *  @return The first matching observation object.
+ */
++ (TO_nullable TOObservation *)findObservationForObserver:(TO_nullable id)observer object:(TO_nullable id)object hashKey:(NSString *)hashKey matchingTest:(TO_nullable BOOL(^)(TOObservation *observation))testBlock;
+
 // expected to only be useful for test code:
 + (NSSet *)associatedObservationsForObserver:(id)observer;
 + (NSSet *)associatedObservationsForObservee:(id)object;
@@ -141,6 +248,38 @@ NS_ASSUME_NONNULL_BEGIN
  *  Perform the specific mechanism to cancel the observation's registeration. This gets called
  */
 - (void)deregisterInternal;
+
+/**
+ *  A canonical key derived from the observation's creation parameters, other than observer and observee, which
+ *  is used to index the observation for `findObservationForObserver:object:hashKey:matchingTest:`. Should include
+ *  something identifying the subclass, and must not change while the observation is registered.
+ *
+ *  The default returns `nil`, and the observation will only be found by the linear search done by
+ *  `findObservationForObserver:object:matchingTest:`.
+ */
+- (TO_nullable NSString *)hashKey;
+
+/**
+ *  A new unregistered copy of the observation, with the same creation parameters and `sourceObservation` set to
+ *  the receiver, whose properties `invokeOnQueueForEvent:` can set to describe a single trigger. Called on the
+ *  triggering thread.
+ *
+ *  The default returns `nil`, in which case the observation doesn't support `batchBlock` or `deliversEventCopies`,
+ *  and setting its properties isn't deferred to the queue by a copy either.
+ */
+- (TO_nullable instancetype)eventCopy;
+
+/**
+ *  Set the receiver's properties describing a trigger from those of a copy made by `eventCopy`, called on the
+ *  correct queue right before the block. The default does nothing.
+ */
+- (void)takeEventFromCopy:(TOObservation *)event;
+
+/**
+ *  Clear the properties describing a trigger, so a copy made by `eventCopy` doesn't keep their values alive while
+ *  it waits to be reused. The default does nothing.
+ */
+- (void)clearEvent;
 @end
 
 #if __has_feature(nullability)
@@ -18,6 +18,7 @@ NS_ASSUME_NONNULL_BEGIN
 #define TO_nullable
 #endif
 
+@protocol TOExecutor;
 @class TOObservation;
 
 /**
@@ -37,6 +38,101 @@ typedef void (^TOObservationBlock)(id obj, TOObservation *observation);
  */
 typedef void (^TOAnonymousObservationBlock)(TOObservation *observation);
 
+/**
+ *  A block called when an observation is triggered with potentially multiple results are available at once.
+ *
+ *  @param obj          The observing object. Often this can be used in place of a weak `self` capture.
+ *  @param observations Array of the triggered observation objects. Details about the observation that was
+ *                      triggered, plus any payload or associated metadata will be properties of this object.
+ *                      Some objects in the array may be a copies of the original instance that represents the
+ *                      overall observation. Any of these copies will forward the `remove` method call to the
+ *                      original observer instance.
+ */
+typedef void (^TOCollatedObservationBlock)(id obj, NSArray *observations);
+
+/**
+ *  A block called when an observation goes silent, see `startWatchdogWithThreshold:block:`.
+ *
+ *  @param observation The observation that went silent.
+ *  @param silence     How long it had been since the observation was last triggered, or since the watchdog started
+ *                     if it hadn't been triggered since.
+ */
+typedef void (^TOWatchdogBlock)(TOObservation *observation, NSTimeInterval silence);
+
+/**
+ *  How an observation arranges to be removed automatically when its observer or observee is deallocated.
+ */
+typedef NS_ENUM(NSInteger, TOAutomaticRemovalMode) {
+    /**
+     *  Replace the `dealloc` method of the observer's and observee's classes, once per class. Affects every instance
+     *  of those classes, though instances that were never observed skip straight to the original `dealloc`. This
+     *  is the default.
+     */
+    TOAutomaticRemovalModeSwizzleDealloc = 0,
+    /**
+     *  Attach a sentinel associated object to the observer and observee, which removes observations when it's
+     *  released along with that object. Doesn't modify any class, so works with classes that can't safely have
+     *  their `dealloc` replaced, and only costs anything for instances that are actually observed.
+     *
+     *  The sentinel is released late in deallocation, after weak references to the object already read as `nil`.
+     *  For KVO observations, this relies on the OS unregistering observers of a deallocated object on its own,
+     *  which is only the case as of iOS 11 and macOS 10.13.
+     */
+    TOAutomaticRemovalModeLifetimeSentinel,
+    /**
+     *  Don't arrange for automatic removal at all, the observation's `removeAutomatically` property will be `NO`.
+     */
+    TOAutomaticRemovalModeNone
+};
+
+/**
+ *  What an observation does with a trigger when `maximumPendingDeliveries` triggers are already waiting for delivery.
+ */
+typedef NS_ENUM(NSInteger, TODeliveryOverflowPolicy) {
+    /**
+     *  Drop the oldest trigger waiting, so the block sees the latest ones. This is the default.
+     */
+    TODeliveryOverflowPolicyDropOldest = 0,
+    /**
+     *  Drop the new trigger, so the block sees the ones already waiting.
+     */
+    TODeliveryOverflowPolicyDropNewest,
+    /**
+     *  Block the triggering thread until a delivery makes room, slowing whatever triggers the observation down to
+     *  the pace of the block. Must only be used if the thread triggering the observation is never one that
+     *  deliveries depend on, such as the main thread delivering to the main queue. Triggers from within the block
+     *  itself are dropped instead.
+     */
+    TODeliveryOverflowPolicyBlockTrigger
+};
+
+/**
+ *  How an observation limits the rate at which its triggers are delivered, see `rateLimit`.
+ */
+typedef NS_ENUM(NSInteger, TORateLimit) {
+    /**
+     *  Deliver every trigger. This is the default.
+     */
+    TORateLimitNone = 0,
+    /**
+     *  Deliver a trigger right away, then drop all others until `rateLimitInterval` has passed.
+     */
+    TORateLimitThrottleLeading,
+    /**
+     *  Hold a trigger for `rateLimitInterval`, then deliver the latest trigger that occurred in that time.
+     */
+    TORateLimitThrottleTrailing,
+    /**
+     *  Deliver the latest trigger once no others have occurred for `rateLimitInterval`.
+     */
+    TORateLimitDebounce,
+    /**
+     *  Deliver the latest trigger at a fixed rate of once every `rateLimitInterval`, skipping intervals in which no
+     *  triggers occurred.
+     */
+    TORateLimitSample
+};
+
 
 #pragma mark -
 
@@ -78,6 +174,9 @@ typedef void (^TOAnonymousObservationBlock)(TOObservation *observation);
  *  when observation is triggered. Can be `nil` if a GCD queue is to be used instead. (read-only)
  *
  *  If both this and `gcdQueue` are `nil`, then the queue and thread the block is executed on is undefined.
+ *
+ *  Reflects `executor`, so is the operation queue of a `TOOperationQueueExecutor` assigned to it, or of one wrapped
+ *  by a `TOAggregatingExecutor`, `nil` for any other executor.
  */
 @property (nonatomic, readonly, TO_nullable) NSOperationQueue *queue;
 
@@ -86,9 +185,36 @@ typedef void (^TOAnonymousObservationBlock)(TOObservation *observation);
  *  observation is triggered. Can be `nil` if an observation queue is to be used instead. (read-only)
  *
  *  If both this and `queue` are nil, then the queue and thread the block is executed on is undefined.
+ *
+ *  Reflects `executor`, so is the queue of a `TOGCDQueueExecutor` assigned to it, or of one wrapped by a
+ *  `TOAggregatingExecutor`, `nil` for any other executor.
  */
 @property (nonatomic, readonly, TO_nullable) dispatch_queue_t gcdQueue;
 
+/**
+ *  What runs the block when the observation is triggered, `nil` to run it synchronously as each trigger occurs.
+ *  Observations created with a `queue` or `gcdQueue` start with an executor wrapping it, or the queue's shared
+ *  `TOAggregatingExecutor` if `aggregatesQueuedDeliveries` is set and the queue is serial. Others start with `nil`,
+ *  or one of `TOShardedExecutor`'s shards if `shardsUnqueuedDeliveries` is set.
+ *
+ *  A different strategy can be picked per observation, such as a `TOTargetQueueExecutor` to skip the hop onto a
+ *  queue when triggers already occur there, by creating it with one of the `to_observe..` methods taking an executor.
+ *  Can only be set before the observation is registered, raises `NSGenericException` after that. Also not to be set
+ *  on notification observations created with a `queue`, whose notification center registration already delivers to
+ *  that queue.
+ */
+@property (nonatomic, TO_nullable) id<TOExecutor> executor;
+
+/**
+ *  The quality of service the block is run at when delivered through `executor`, so that latency-critical observations
+ *  can be kept ahead of others sharing the same queues. `NSQualityOfServiceDefault` by default, which runs it at the
+ *  quality of service of the thread the trigger occurred on, as GCD does.
+ *
+ *  Executors not implementing the optional quality of service methods of `TOExecutor` ignore it, as do notification
+ *  observations created with a `queue`. Has no effect if `executor` is `nil`.
+ */
+@property (nonatomic) NSQualityOfService qualityOfService;
+
 /**
  *  The block provided when the observation was created, which will be executed when the observation is triggered.
  *  Can be `nil` if the observation was created with no observer, and thus uses the other block property. (read-only)
@@ -120,7 +246,7 @@ typedef void (^TOAnonymousObservationBlock)(TOObservation *observation);
 
 /**
  *  Whether the observation should be removed automatically upon either the observer or observee being deallocated.
- *  Set to `NO` to prevent automatic removal. (default is `YES`)
+ *  Set to `NO` to prevent automatic removal. (default is `YES`, unless created with `TOAutomaticRemovalModeNone`)
  *
  *  If not being removed automatically, then the caller is taking responsibility for calling the `remove` method
  *  when objects are deallocated and the observation becomes invalid. The impact of not doing so may or may not
@@ -128,11 +254,126 @@ typedef void (^TOAnonymousObservationBlock)(TOObservation *observation);
  *  not being released.
  *
  *  NB: there's no opportunity for the caller to set this property before `dealloc` methods are swizzled on observer
- *  and observee objects. If hoping to set this property  to `NO` to avoid swizzling being used on your objects,
- *  there's no way at the moment.
+ *  and observee objects. To avoid swizzling being used on your objects, create the observation within a call to
+ *  `performWithAutomaticRemovalMode:block:` instead.
  */
 @property (nonatomic) BOOL removeAutomatically;
 
+/**
+ *  How the observation arranges to be removed automatically, chosen when the observation was created from either
+ *  `performWithAutomaticRemovalMode:block:` or `defaultAutomaticRemovalMode`. (read-only)
+ */
+@property (nonatomic, readonly) TOAutomaticRemovalMode automaticRemovalMode;
+
+/**
+ *  Whether triggers that occur while a delivery to `queue` or `gcdQueue` is still pending are merged into that
+ *  delivery instead of each making their own. (default is `NO`)
+ *
+ *  When `YES`, at most one call to the observation block is pending at any time. Its properties describe the
+ *  latest trigger, such as the latest KVO change or notification, and `coalescedTriggerCount` tells how many
+ *  triggers were merged into it. Useful when an observed value changes much faster than the block needs to see it,
+ *  for instance updating UI on the main queue with a property changed rapidly on a worker thread.
+ *
+ *  Has no effect if `executor` is `nil`, since the block is then called as each trigger occurs, nor on reliable app
+ *  group observations, which already collect every post for their block.
+ */
+@property (nonatomic) BOOL coalescesDeliveries;
+
+/**
+ *  How many triggers were merged into the current call to the observation block when `coalescesDeliveries` is
+ *  `YES`, 1 otherwise. Value undefined except within call to an observation block. (read-only)
+ */
+@property (nonatomic, readonly) NSUInteger coalescedTriggerCount;
+
+/**
+ *  The block provided when the observation was created with a batch block, which will be executed with all
+ *  triggers that accumulated while waiting for `queue` or `gcdQueue`, in order. `nil` if the observation was
+ *  created with one of the other block properties. (read-only)
+ *
+ *  Each observation in the array passed to the block is a copy describing one trigger, whose `sourceObservation`
+ *  property refers back to the receiver.
+ */
+@property (nonatomic, readonly, copy, TO_nullable) TOCollatedObservationBlock batchBlock;
+
+/**
+ *  The most triggers passed to `batchBlock` at once, once reached the batch is delivered without waiting any
+ *  longer and further triggers start a new batch. 0 for no limit. (default is 0)
+ */
+@property (nonatomic) NSUInteger maximumBatchSize;
+
+/**
+ *  How long to wait after the first trigger of a batch before delivering it to `queue` or `gcdQueue`, so that
+ *  more triggers have a chance to join it. 0 to deliver as soon as the queue gets to it, in which case only
+ *  triggers that occur while the queue is busy are batched together. (default is 0)
+ */
+@property (nonatomic) NSTimeInterval maximumBatchLatency;
+
+/**
+ *  Whether the block is passed a copy of the observation describing just the one trigger, instead of the receiver
+ *  itself whose properties are overwritten by every trigger. (default is `NO`)
+ *
+ *  Lets blocks called on a concurrent `gcdQueue` or operation queue read the details of their trigger, such as the
+ *  KVO change or the notification, in parallel and without racing against later triggers. The copies are kept in
+ *  a small pool and reused, so a copy must not be kept beyond the block it's passed to, keep its
+ *  `sourceObservation` instead. Only KVO, notification, and non-reliable app group observations make copies, others
+ *  pass the receiver.
+ */
+@property (nonatomic) BOOL deliversEventCopies;
+
+/**
+ *  The most triggers left waiting for delivery by `executor` at once, beyond which `deliveryOverflowPolicy` applies.
+ *  0 for no limit. (default is 0)
+ *
+ *  When this or `maximumDeliveryDelay` is set, triggers wait in a buffer belonging to the observation instead of
+ *  each being handed to the executor, and are delivered one at a time in order. Must be set right after creating the
+ *  observation, before it can trigger. Has no effect if `executor` is `nil`, if the observation coalesces or
+ *  batches its deliveries, or on observations other than KVO, notification, and non-reliable app group ones.
+ */
+@property (nonatomic) NSUInteger maximumPendingDeliveries;
+
+/**
+ *  What to do with a trigger when `maximumPendingDeliveries` triggers are already waiting.
+ *  (default is `TODeliveryOverflowPolicyDropOldest`)
+ */
+@property (nonatomic) TODeliveryOverflowPolicy deliveryOverflowPolicy;
+
+/**
+ *  How long a trigger can wait for delivery, after which it's dropped rather than delivered late. 0 for no limit.
+ *  (default is 0)
+ *
+ *  See `maximumPendingDeliveries` for when this applies.
+ */
+@property (nonatomic) NSTimeInterval maximumDeliveryDelay;
+
+/**
+ *  The number of triggers dropped due to `maximumPendingDeliveries` or `maximumDeliveryDelay`. (read-only)
+ */
+@property (nonatomic, readonly) NSUInteger droppedTriggerCount;
+
+/**
+ *  How the rate of deliveries is limited, for sources that trigger faster than is useful to handle, such as progress
+ *  updates. (default is `TORateLimitNone`)
+ *
+ *  Applied as each trigger occurs, before it's given to `executor`, so triggers that are dropped are never queued.
+ *  Leading throttles are lock-free and drop triggers before anything is done with them. The others keep the latest
+ *  trigger, reusing copies as `deliversEventCopies` does for observations that support it, and deliver it when a timer
+ *  fires on a global queue. So observations without an `executor` are called on that queue instead of the
+ *  triggering thread. Must be set, along with `rateLimitInterval`, right after creating the observation, before it
+ *  can trigger.
+ */
+@property (nonatomic) TORateLimit rateLimit;
+
+/**
+ *  The interval used by `rateLimit`, which has no effect unless this is greater than 0. (default is 0)
+ */
+@property (nonatomic) NSTimeInterval rateLimitInterval;
+
+/**
+ *  If this instance is a copy passed to `batchBlock` or made for `deliversEventCopies`, the original observation
+ *  that was created and registered, `nil` otherwise. Calling `remove` on a copy removes the original. (read-only)
+ */
+@property (nonatomic, readonly, weak, TO_nullable) TOObservation *sourceObservation;
+
 /**
  *  Explicitly remove, or deregister, the observation.
  *
@@ -142,6 +383,92 @@ typedef void (^TOAnonymousObservationBlock)(TOObservation *observation);
  */
 - (void)remove;
 
+/**
+ *  Start a watchdog that calls `block` when the observation goes silent, not having been triggered for longer than
+ *  `threshold`, such as a KVO key path, notification or app group post that's expected to keep recurring. It's called
+ *  once for each silent period, after which the next trigger starts watching for another. Replaces any watchdog started
+ *  before.
+ *
+ *  Noting each trigger only stores the time, and all watchdogs share a single timer thread rather than each having its
+ *  own timer, so this is suitable for very many observations. The block is called using `executor` if there is one,
+ *  otherwise on a global queue, and isn't called once the observation is removed.
+ *
+ *  @param threshold How long without a trigger is considered silent, must be greater than 0.
+ *  @param block     The block to call once the observation goes silent.
+ */
+- (void)startWatchdogWithThreshold:(NSTimeInterval)threshold block:(TOWatchdogBlock)block;
+
+/**
+ *  Stop the watchdog started by `startWatchdogWithThreshold:block:`, if any. Removing the observation does this too.
+ */
+- (void)stopWatchdog;
+
+
+/**
+ *  The automatic removal mode used by observations created outside of `performWithAutomaticRemovalMode:block:`.
+ *  (default is `TOAutomaticRemovalModeSwizzleDealloc`)
+ */
++ (TOAutomaticRemovalMode)defaultAutomaticRemovalMode;
+
+/**
+ *  Change the automatic removal mode used by observations created outside of `performWithAutomaticRemovalMode:block:`.
+ *  Doesn't affect observations already created.
+ *
+ *  @param mode The new default mode.
+ */
++ (void)setDefaultAutomaticRemovalMode:(TOAutomaticRemovalMode)mode;
+
+/**
+ *  Call a block within which all observations created on the current thread use the given automatic removal mode,
+ *  overriding `defaultAutomaticRemovalMode`. Calls can be nested.
+ *
+ *  @param mode  The mode for observations created by `block`.
+ *  @param block A block which calls `to_observe...` methods.
+ */
++ (void)performWithAutomaticRemovalMode:(TOAutomaticRemovalMode)mode block:(void(^)(void))block;
+
+/**
+ *  Whether observations created without a `queue` or `gcdQueue` deliver on a shard of
+ *  `+[TOShardedExecutor sharedExecutor]` rather than synchronously on the thread where each trigger occurs.
+ *  (default is `NO`)
+ *
+ *  Each such observation is hashed to one of the shard queues, so its block is called in the order the triggers
+ *  occurred but without holding up the thread triggering it, such as the one calling a KVO setter or posting a
+ *  notification. Not suitable for observations whose blocks must run on the triggering thread, like ones updating
+ *  user interface from the main thread.
+ */
++ (BOOL)shardsUnqueuedDeliveries;
+
+/**
+ *  Change whether observations created without a `queue` or `gcdQueue` deliver on a shard of
+ *  `+[TOShardedExecutor sharedExecutor]`. Doesn't affect observations already created.
+ *
+ *  @param shards `YES` to deliver on shards, `NO` to deliver synchronously.
+ */
++ (void)setShardsUnqueuedDeliveries:(BOOL)shards;
+
+/**
+ *  Whether observations created with a `queue` or `gcdQueue` deliver through that queue's shared
+ *  `TOAggregatingExecutor`, rather than each giving the queue its own work. (default is `NO`)
+ *
+ *  When a single change triggers many observations delivering to the same queue, such as a model update observed
+ *  throughout the user interface, all their deliveries are run by one drain on the queue, in the order triggered,
+ *  instead of waking the queue or adding an operation for each one.
+ *
+ *  Only applies to queues known to be serial, the main queue and operation queues whose `maxConcurrentOperationCount`
+ *  is 1, since one drain would run deliveries one at a time that a concurrent queue would have run in parallel.
+ *  Observations with other queues give the queue each delivery as usual.
+ */
++ (BOOL)aggregatesQueuedDeliveries;
+
+/**
+ *  Change whether observations created with a `queue` or `gcdQueue` deliver through that queue's shared
+ *  `TOAggregatingExecutor`. Doesn't affect observations already created.
+ *
+ *  @param aggregates `YES` to deliver through the shared aggregating executors, `NO` to give the queue each delivery.
+ */
++ (void)setAggregatesQueuedDeliveries:(BOOL)aggregates;
+
 @end
 
 #if __has_feature(nullability)
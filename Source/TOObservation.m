@@ -8,15 +8,22 @@
 //  TODO:
 //  - consider using a global GCD queue when queue and cgdQueue both nil, either a private one or always
 //    the main queue, this is to avoid a triggered observation interrupting its own currenly-running
-//    observation block from changing its properties. possible?
-//  - alternately make observation object copyable and pass a copy the observation block instead of the
-//    original, this prevents that block from being able to compare observation instance pointers,
-//    which is probably of limited use anyhow
+//    observation block from changing its properties. possible? (deliversEventCopies avoids this when opted into)
 
 #import "TOObservation.h"
 #import "TOObservation+Private.h"
+#import "TOExecutor.h"
+#import "TOExecutor+Private.h"
+#import "TODeliveryBuffer.h"
+#import "TORateLimiter.h"
+#import "TOWatchdog.h"
+#import "TOObservationRegistry.h"
+#import "TOObservationBag+Private.h"
+#import "TOStripedLock.h"
 #import <objc/runtime.h>
 #import <objc/message.h>
+#import <stdatomic.h>
+#import <pthread.h>
 
 #if __has_feature(nullability)
 NS_ASSUME_NONNULL_BEGIN
@@ -24,24 +31,130 @@ NS_ASSUME_NONNULL_BEGIN
 #define nullable
 #endif
 
-@interface TOObservation ()
+@interface TOObservation () {
+    // pending coalesced delivery, guarded by the striped lock for self
+    void (^_pendingSetup)(void);
+    void (^_pendingInvoke)(void);
+    NSUInteger _pendingTriggerCount;
+    dispatch_source_t _coalescingSource; // wakes delivery to directGCDQueue, created on first coalesced trigger
+    
+    // batches waiting for delivery to batchBlock, also guarded by the striped lock for self
+    NSMutableArray *_openBatch;      // still accepting events
+    NSMutableArray *_closedBatches;  // reached maximumBatchSize, oldest first, delivered ahead of the open one
+    
+    // copies made by eventCopy waiting to be reused for deliversEventCopies, also guarded by the striped lock for self
+    NSMutableArray *_idleEventCopies;
+    
+    // created on first trigger if maximumPendingDeliveries or maximumDeliveryDelay is set, also guarded by the
+    // striped lock for self, shut down and cleared by remove, with the triggers it had dropped kept in the count
+    TODeliveryBuffer *_deliveryBuffer;
+    NSUInteger _removedBuffersDroppedCount;
+    
+    // created on first trigger if rateLimit is set, also guarded by the striped lock for self, never changes once set
+    TORateLimiter *_rateLimiter;
+    
+    // set by startWatchdogWithThreshold:block:, also guarded by the striped lock for self, while _watched lets
+    // triggers skip taking the lock when there's no watchdog
+    TOWatchdog *_watchdog;
+    _Atomic(bool) _watched;
+    
+    // incremented by remove, deliveries already on their way compare it to the value when they were triggered
+    _Atomic(NSUInteger) _generation;
+}
 @property (nonatomic, readwrite, weak, nullable) id observer;
 @property (nonatomic, readwrite, weak, nullable) id object; // some overlap of term 'object' in here, consider naming this 'observee'
 
-@property (nonatomic, readwrite, nullable) NSOperationQueue *queue;
-@property (nonatomic, readwrite, nullable) dispatch_queue_t gcdQueue;
 
 @property (nonatomic, readwrite, copy, nullable) TOAnonymousObservationBlock anonymousBlock; // code enforces one of these will be nonnull
 @property (nonatomic, readwrite, copy, nullable) TOObservationBlock objectBlock;
+@property (nonatomic, readwrite, copy, nullable) TOCollatedObservationBlock batchBlock;
+@property (nonatomic, readwrite, weak, nullable) TOObservation *sourceObservation;
+@property (nonatomic) NSUInteger triggerGeneration; // on a copy, the original's generation when triggered
+@property (nonatomic, nullable) TOObservation *deliveringObservation; // set on a copy in flight to the executor, holds the original like a block would
 
 @property (nonatomic, readwrite) BOOL registered;
-@end
+@property (nonatomic, readwrite) TOAutomaticRemovalMode automaticRemovalMode;
+@property (nonatomic, readwrite) NSUInteger coalescedTriggerCount;
+
+@property (nonatomic, copy, nullable) NSString *indexKey; // set when stored, so removal uses same key even after weak properties are cleared
+@property (nonatomic) BOOL removingAutomatically; // set while removed for a deallocating object, whose weak property already reads nil
 
-static const int TOObservationSetKeyVar;
-static void *TOObservationSetKey = (void *)&TOObservationSetKeyVar;
++ (void)performAutomaticRemovalForObservations:(nullable NSSet *)observationSet;
+@end
 
 static NSMutableSet *classesSwizzledSet = nil;
 
+#define TO_IDLE_EVENT_COPIES_LIMIT 16 // beyond this, copies are discarded after delivery instead of being kept to reuse
+
+static void TODeliverEventCopy(void *context);
+static void TODrainDeliveryBuffer(void *context);
+
+static const int TOLifetimeSentinelKeyVar;
+static void *TOLifetimeSentinelKey = (void *)&TOLifetimeSentinelKeyVar;
+
+static TOAutomaticRemovalMode defaultAutomaticRemovalMode = TOAutomaticRemovalModeSwizzleDealloc;
+static pthread_key_t automaticRemovalModeOverrideKey; // thread's mode + 1, so that 0 means no override
+static BOOL shardsUnqueuedDeliveries = NO;
+static BOOL aggregatesQueuedDeliveries = NO;
+
+// lock-free mirror of classesSwizzledSet checked before taking its lock, open addressing with linear probing
+// slots are only ever filled (with the lock held) and never cleared, if it fills up the set is still authoritative
+#define TO_SWIZZLED_CLASS_SLOTS 1024 // must be a power of 2
+static _Atomic(uintptr_t) swizzledClassSlots[TO_SWIZZLED_CLASS_SLOTS];
+
+static inline NSUInteger TOSwizzledClassSlotIndex(Class class)
+{
+    uintptr_t bits = (uintptr_t)class;
+    return ((bits >> 3) ^ (bits >> 12)) & (TO_SWIZZLED_CLASS_SLOTS - 1);
+}
+
+static BOOL TOSwizzledClassSlotsContain(Class class)
+{
+    NSUInteger i = TOSwizzledClassSlotIndex(class);
+    for (NSUInteger probes = 0; probes < TO_SWIZZLED_CLASS_SLOTS; ++probes, i = (i + 1) & (TO_SWIZZLED_CLASS_SLOTS - 1)) {
+        uintptr_t slot = atomic_load_explicit(&swizzledClassSlots[i], memory_order_acquire);
+        if (slot == (uintptr_t)class)
+            return YES;
+        if (slot == 0)
+            return NO;
+    }
+    return NO;
+}
+
+static void TOSwizzledClassSlotsInsert(Class class)
+{
+    NSUInteger i = TOSwizzledClassSlotIndex(class);
+    for (NSUInteger probes = 0; probes < TO_SWIZZLED_CLASS_SLOTS; ++probes, i = (i + 1) & (TO_SWIZZLED_CLASS_SLOTS - 1)) {
+        if (atomic_load_explicit(&swizzledClassSlots[i], memory_order_relaxed) == 0) {
+            atomic_store_explicit(&swizzledClassSlots[i], (uintptr_t)class, memory_order_release);
+            return;
+        }
+    }
+}
+
+
+#pragma mark -
+
+/**
+ *  Associated with an observed object in `TOAutomaticRemovalModeLifetimeSentinel`, gets released along with the
+ *  object's other associated objects. By then the registry can no longer be looked-up from the object, so the
+ *  sentinel keeps its own reference to it.
+ */
+@interface TOLifetimeSentinel : NSObject
+@property (nonatomic) TOObservationRegistry *registry;
+@end
+
+@implementation TOLifetimeSentinel
+
+- (void)dealloc
+{
+    @autoreleasepool {
+        [TOObservation performAutomaticRemovalForObservations:[_registry observationSnapshot]];
+    }
+}
+
+@end
+
 
 #pragma mark -
 
@@ -64,10 +177,12 @@ static NSMutableSet *classesSwizzledSet = nil;
         return nil;
     _observer = observer;
     _object = object;
-    _queue = queue;
-    _gcdQueue = cgdQueue;
+    _executor = [TOObservation executorForQueue:queue gcdQueue:cgdQueue observation:self];
     _objectBlock = block;
-    _removeAutomatically = YES;
+    _coalescedTriggerCount = 1;
+    _automaticRemovalMode = [TOObservation currentAutomaticRemovalMode];
+    _removeAutomatically = _automaticRemovalMode != TOAutomaticRemovalModeNone;
+    _qualityOfService = NSQualityOfServiceDefault;
     return self;
 }
 
@@ -76,32 +191,260 @@ static NSMutableSet *classesSwizzledSet = nil;
     if (!(self = [super init]))
         return nil;
     _object = object;
-    _queue = queue;
-    _gcdQueue = cgdQueue;
+    _executor = [TOObservation executorForQueue:queue gcdQueue:cgdQueue observation:self];
     _anonymousBlock = block;
-    _removeAutomatically = YES;
+    _coalescedTriggerCount = 1;
+    _automaticRemovalMode = [TOObservation currentAutomaticRemovalMode];
+    _removeAutomatically = _automaticRemovalMode != TOAutomaticRemovalModeNone;
+    _qualityOfService = NSQualityOfServiceDefault;
+    return self;
+}
+
+- (instancetype)initWithObserver:(nullable id)observer object:(nullable id)object queue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)cgdQueue batchBlock:(nullable TOCollatedObservationBlock)block
+{
+    if (!(self = [self initWithObserver:observer object:object queue:queue gcdQueue:cgdQueue block:nil]))
+        return nil;
+    _batchBlock = block;
+    return self;
+}
+
+- (instancetype)initWithObserver:(nullable id)observer object:(nullable id)object executor:(nullable id<TOExecutor>)executor block:(nullable TOObservationBlock)block
+{
+    if (!(self = [self initWithObserver:observer object:object queue:nil gcdQueue:nil block:block]))
+        return nil;
+    _executor = executor;
+    return self;
+}
+
+- (instancetype)initWithObject:(nullable id)object executor:(nullable id<TOExecutor>)executor block:(nullable TOAnonymousObservationBlock)block
+{
+    if (!(self = [self initWithObject:object queue:nil gcdQueue:nil block:block]))
+        return nil;
+    _executor = executor;
     return self;
 }
 
++ (nullable id<TOExecutor>)executorForQueue:(nullable NSOperationQueue *)queue gcdQueue:(nullable dispatch_queue_t)gcdQueue observation:(TOObservation *)observation
+{
+    // one drain would serialize a concurrent queue, and the main queue is the only GCD queue known to be serial
+    if (queue != nil && aggregatesQueuedDeliveries && queue.maxConcurrentOperationCount == 1)
+        return [TOAggregatingExecutor executorForOperationQueue:queue];
+    else if (queue != nil)
+        return [[TOOperationQueueExecutor alloc] initWithOperationQueue:queue];
+    else if (gcdQueue != nil && aggregatesQueuedDeliveries && gcdQueue == dispatch_get_main_queue())
+        return [TOAggregatingExecutor executorForQueue:gcdQueue];
+    else if (gcdQueue != nil)
+        return [[TOGCDQueueExecutor alloc] initWithQueue:gcdQueue];
+    else if (shardsUnqueuedDeliveries)
+        return [[TOShardedExecutor sharedExecutor] executorForKey:(__bridge const void *)observation];
+    else
+        return nil;
+}
+
+- (void)setExecutor:(nullable id<TOExecutor>)executor
+{
+    // triggers read it without a lock, so it can't change under them
+    if (self.registered)
+        [NSException raise:NSGenericException format:@"Observation already registered, cannot change its executor"];
+    _executor = executor;
+}
+
+- (nullable NSOperationQueue *)queue
+{
+    id<TOExecutor> executor = [self unaggregatedExecutor];
+    return [executor isKindOfClass:[TOOperationQueueExecutor class]] ? ((TOOperationQueueExecutor *)executor).operationQueue : nil;
+}
+
+- (nullable dispatch_queue_t)gcdQueue
+{
+    id<TOExecutor> executor = [self unaggregatedExecutor];
+    return [executor isKindOfClass:[TOGCDQueueExecutor class]] ? ((TOGCDQueueExecutor *)executor).queue : nil;
+}
+
+- (nullable dispatch_queue_t)directGCDQueue
+{
+    // the queue that coalesced and delayed deliveries can target themselves, only for a plain GCD queue executor since
+    // going around any other, such as an aggregating or target queue executor, would lose what it does differently
+    id<TOExecutor> executor = self.executor;
+    return [executor class] == [TOGCDQueueExecutor class] ? ((TOGCDQueueExecutor *)executor).queue : nil;
+}
+
+- (nullable id<TOExecutor>)unaggregatedExecutor
+{
+    // an aggregating executor still delivers to the same queue, just alongside other observations
+    id<TOExecutor> executor = self.executor;
+    return [executor isKindOfClass:[TOAggregatingExecutor class]] ? ((TOAggregatingExecutor *)executor).executor : executor;
+}
+
+- (void)dealloc
+{
+    if (_coalescingSource != nil)
+        dispatch_source_cancel(_coalescingSource);
+}
+
 - (void)register
 {
     if (self.registered)
         [NSException raise:NSGenericException format:@"Observation already registered, cannot register again"];
     
     [self registerInternal];
-    [self storeAssociatedObservation];
-    [self adoptAutomaticRemoval];
+    if (![TOObservationBag deferStoringObservation:self]) {
+        [self storeAssociatedObservation];
+        [self adoptAutomaticRemoval];
+    }
     self.registered = YES;
 }
 
 - (void)remove
 {
+    if (self.sourceObservation != nil) {
+        [self.sourceObservation remove];
+        return;
+    }
     if (!self.registered)
         return;
     
-    [self deregisterInternal];
+    [self deregisterForRemoval];
     [self removeAssociatedObservation];
+}
+
+- (void)deregisterForRemoval
+{
+    [self deregisterInternal];
     self.registered = NO;
+    [self cancelPendingDeliveries];
+    [self stopWatchdog];
+}
+
+- (void)cancelPendingDeliveries
+{
+    // what's already handed to the executor is skipped when it runs, what's still held here is dropped now
+    atomic_fetch_add(&_generation, 1);
+    
+    void (^pendingSetup)(void) NS_VALID_UNTIL_END_OF_SCOPE = nil;
+    void (^pendingInvoke)(void) NS_VALID_UNTIL_END_OF_SCOPE = nil;
+    NSArray *openBatch NS_VALID_UNTIL_END_OF_SCOPE = nil;
+    NSArray *closedBatches NS_VALID_UNTIL_END_OF_SCOPE = nil;
+    
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    
+    pendingSetup = _pendingSetup;
+    pendingInvoke = _pendingInvoke;
+    _pendingSetup = nil;
+    _pendingInvoke = nil;
+    _pendingTriggerCount = 0;
+    openBatch = _openBatch;
+    closedBatches = _closedBatches;
+    _openBatch = nil;
+    _closedBatches = nil;
+    TODeliveryBuffer *buffer = _deliveryBuffer;
+    _deliveryBuffer = nil; // a drain already scheduled holds onto it, but finds it empty
+    _removedBuffersDroppedCount += buffer.droppedCount;
+    TORateLimiter *limiter = _rateLimiter;
+    
+    TOStripedLockUnlock(lockAddress);
+    
+    [buffer shutDown];
+    [limiter removeHeldTrigger];
+}
+
+- (void)startWatchdogWithThreshold:(NSTimeInterval)threshold block:(TOWatchdogBlock)block
+{
+    if (self.sourceObservation != nil) {
+        [self.sourceObservation startWatchdogWithThreshold:threshold block:block];
+        return;
+    }
+    
+    typeof(self) __weak welf = self;
+    TOWatchdog *watchdog = [[TOWatchdog alloc] initWithThreshold:threshold handler:^(NSTimeInterval silence) {
+        TOObservation *observation = welf;
+        if (observation == nil || !observation.registered)
+            return;
+        if (observation.executor != nil) {
+            [observation executeBlock:^{
+                block(observation, silence);
+            }];
+        }
+        else {
+            block(observation, silence);
+        }
+    }];
+    TOWatchdog *replaced NS_VALID_UNTIL_END_OF_SCOPE = nil;
+    
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    replaced = _watchdog;
+    _watchdog = watchdog;
+    atomic_store(&_watched, true);
+    TOStripedLockUnlock(lockAddress);
+    
+    [replaced stop];
+}
+
+- (void)stopWatchdog
+{
+    if (self.sourceObservation != nil) {
+        [self.sourceObservation stopWatchdog];
+        return;
+    }
+    
+    TOWatchdog *watchdog NS_VALID_UNTIL_END_OF_SCOPE = nil;
+    
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    watchdog = _watchdog;
+    _watchdog = nil;
+    atomic_store(&_watched, false);
+    TOStripedLockUnlock(lockAddress);
+    
+    [watchdog stop];
+}
+
+- (void)noteTriggerForWatchdog
+{
+    if (!atomic_load_explicit(&_watched, memory_order_relaxed))
+        return;
+    
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    TOWatchdog *watchdog = _watchdog;
+    TOStripedLockUnlock(lockAddress);
+    
+    [watchdog noteTrigger];
+}
+
+- (BOOL)isCurrentGeneration:(NSUInteger)generation
+{
+    return atomic_load(&_generation) == generation;
+}
+
+- (void)executeBlock:(dispatch_block_t)block
+{
+    id<TOExecutor> executor = self.executor;
+    NSQualityOfService qualityOfService = self.qualityOfService;
+    if (qualityOfService != NSQualityOfServiceDefault && [executor respondsToSelector:@selector(executeBlock:qualityOfService:)])
+        [executor executeBlock:block qualityOfService:qualityOfService];
+    else
+        [executor executeBlock:block];
+}
+
+- (void)executeFunction:(dispatch_function_t)function context:(nullable void *)context
+{
+    id<TOExecutor> executor = self.executor;
+    NSQualityOfService qualityOfService = self.qualityOfService;
+    if (qualityOfService != NSQualityOfServiceDefault && [executor respondsToSelector:@selector(executeFunction:context:qualityOfService:)])
+        [executor executeFunction:function context:context qualityOfService:qualityOfService];
+    else
+        [executor executeFunction:function context:context];
+}
+
+- (dispatch_block_t)blockWithQualityOfService:(dispatch_block_t)block
+{
+    qos_class_t qos = TOQOSClassFromQualityOfService(self.qualityOfService);
+    if (qos == QOS_CLASS_UNSPECIFIED)
+        return block;
+    return dispatch_block_create_with_qos_class(DISPATCH_BLOCK_ENFORCE_QOS_CLASS, qos, 0, block);
 }
 
 - (void)invoke
@@ -116,17 +459,26 @@ static NSMutableSet *classesSwizzledSet = nil;
 
 - (void)invokeOnQueueAfter:(void(^)(void))setup by:(void(^)(void))invoke
 {
-    if (self.queue != nil) {
-        [self.queue addOperationWithBlock:^{
-            setup();
-            invoke();
-        }];
+    [self noteTriggerForWatchdog];
+    if ([self rateLimitTriggerAfter:setup by:invoke])
+        return;
+    [self deliverAfter:setup by:invoke];
+}
+
+- (void)deliverAfter:(void(^)(void))setup by:(void(^)(void))invoke
+{
+    id<TOExecutor> executor = self.executor;
+    if (self.coalescesDeliveries && executor != nil) {
+        [self coalesceInvokeOnQueueAfter:setup by:invoke];
     }
-    else if (self.gcdQueue != nil) {
-        dispatch_async(self.gcdQueue, ^{
+    else if (executor != nil) {
+        NSUInteger generation = atomic_load(&_generation);
+        [self executeBlock:^{
+            if (![self isCurrentGeneration:generation])
+                return; // removed since triggered
             setup();
             invoke();
-        });
+        }];
     }
     else {
         setup();
@@ -134,6 +486,404 @@ static NSMutableSet *classesSwizzledSet = nil;
     }
 }
 
+- (void)coalesceInvokeOnQueueAfter:(void(^)(void))setup by:(void(^)(void))invoke
+{
+    // any pending delivery not yet started is replaced, released only after unlocking
+    void (^replacedSetup)(void) NS_VALID_UNTIL_END_OF_SCOPE = nil;
+    void (^replacedInvoke)(void) NS_VALID_UNTIL_END_OF_SCOPE = nil;
+    dispatch_source_t source = nil;
+    BOOL scheduleOperation = NO;
+    
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    
+    replacedSetup = _pendingSetup;
+    replacedInvoke = _pendingInvoke;
+    _pendingSetup = [setup copy];
+    _pendingInvoke = [invoke copy];
+    scheduleOperation = _pendingTriggerCount++ == 0;
+    if (self.directGCDQueue != nil && self.qualityOfService == NSQualityOfServiceDefault) {
+        // source handlers can't be given a quality of service, so those observations use the executor instead
+        if (_coalescingSource == nil)
+            _coalescingSource = [self createCoalescingSource];
+        source = _coalescingSource;
+    }
+    
+    TOStripedLockUnlock(lockAddress);
+    
+    if (source != nil) {
+        dispatch_source_merge_data(source, 1); // any number of merges before the handler runs wake it just once
+    }
+    else if (scheduleOperation) {
+        typeof(self) __weak welf = self;
+        [self executeBlock:^{
+            [welf deliverCoalescedInvocation];
+        }];
+    }
+}
+
+- (dispatch_source_t)createCoalescingSource
+{
+    dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_OR, 0, 0, self.directGCDQueue);
+    typeof(self) __weak welf = self;
+    dispatch_source_set_event_handler(source, ^{
+        [welf deliverCoalescedInvocation];
+    });
+    dispatch_resume(source);
+    return source;
+}
+
+- (void)deliverCoalescedInvocation
+{
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    
+    void (^setup)(void) = _pendingSetup;
+    void (^invoke)(void) = _pendingInvoke;
+    NSUInteger count = _pendingTriggerCount;
+    _pendingSetup = nil;
+    _pendingInvoke = nil;
+    _pendingTriggerCount = 0;
+    
+    TOStripedLockUnlock(lockAddress);
+    
+    if (setup == nil)
+        return; // source woken again by a trigger that an earlier wakeup had already delivered
+    self.coalescedTriggerCount = count;
+    setup();
+    invoke();
+}
+
+- (void)invokeOnQueueForEvent:(void(^)(id observation))setup
+{
+    [self noteTriggerForWatchdog];
+    if ([self rateLimitTriggerForEvent:setup])
+        return;
+    
+    if (self.batchBlock != nil) {
+        TOObservation *event = [self eventCopy];
+        setup(event);
+        [self invokeBatchWithEvent:event];
+        return;
+    }
+    
+    id<TOExecutor> executor = self.executor;
+    if (!self.deliversEventCopies && (executor == nil || self.coalescesDeliveries)) {
+        // called right away, or only the latest trigger's setup is kept, so no need for a copy to hold the trigger
+        [self deliverAfter:^{
+            setup(self);
+        } by:^{
+            [self invoke];
+        }];
+        return;
+    }
+    
+    TOObservation *event = [self dequeueEventCopy];
+    if (event == nil) {
+        [self deliverAfter:^{
+            setup(self); // subclass doesn't make copies
+        } by:^{
+            [self invoke];
+        }];
+        return;
+    }
+    
+    setup(event);
+    event.triggerGeneration = atomic_load(&_generation);
+    [self deliverEvent:event];
+}
+
+- (void)deliverEvent:(TOObservation *)event
+{
+    if (self.batchBlock != nil) {
+        [self invokeBatchWithEvent:event];
+        return;
+    }
+    
+    id<TOExecutor> executor = self.executor;
+    TODeliveryBuffer *buffer = nil;
+    if (self.coalescesDeliveries && executor != nil) {
+        // copies in replaced deliveries are just released rather than reused
+        [self deliverAfter:^{} by:^{
+            [self deliverEventCopy:event];
+        }];
+    }
+    else if (executor != nil && (buffer = [self deliveryBuffer]) != nil) {
+        if ([buffer addEvent:event])
+            [self executeFunction:TODrainDeliveryBuffer context:(__bridge_retained void *)buffer];
+    }
+    else if (executor != nil) {
+        // a function with the copy as its context instead of a block, so that in steady state nothing is allocated
+        event.deliveringObservation = self;
+        [self executeFunction:TODeliverEventCopy context:(__bridge_retained void *)event];
+    }
+    else {
+        [self deliverEventCopy:event];
+    }
+}
+
+- (void)invokeForEvent:(void(^)(id observation))setup
+{
+    [self noteTriggerForWatchdog];
+    if ([self rateLimitTriggerForEvent:setup])
+        return;
+    
+    TOObservation *event = self.deliversEventCopies ? [self dequeueEventCopy] : nil;
+    if (event == nil) {
+        setup(self);
+        [self invoke];
+        return;
+    }
+    
+    setup(event);
+    event.triggerGeneration = atomic_load(&_generation);
+    [self deliverEventCopy:event];
+}
+
+- (void)deliverEventCopy:(TOObservation *)event
+{
+    if (![self isCurrentGeneration:event.triggerGeneration]) {
+        [self recycleEventCopy:event]; // removed since triggered
+        return;
+    }
+    
+    if (!self.deliversEventCopies) {
+        // the copy only carried the trigger to the queue
+        [self takeEventFromCopy:event];
+        [self invoke];
+    }
+    else if (self.anonymousBlock != nil)
+        self.anonymousBlock(event);
+    else if (self.objectBlock != nil)
+        self.objectBlock(self.observer, event);
+    else
+        [NSException raise:NSInternalInconsistencyException format:@"Nil 'block' & 'objectBlock' properties when invoking observation %@", self];
+    [self recycleEventCopy:event];
+}
+
+static void TODeliverEventCopy(void *context)
+{
+    TOObservation *event = (__bridge_transfer TOObservation *)context;
+    TOObservation *observation = event.deliveringObservation;
+    event.deliveringObservation = nil;
+    [observation deliverEventCopy:event];
+}
+
+- (nullable TODeliveryBuffer *)deliveryBuffer
+{
+    if (self.maximumPendingDeliveries == 0 && self.maximumDeliveryDelay <= 0)
+        return nil;
+    
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    
+    if (_deliveryBuffer == nil)
+        _deliveryBuffer = [[TODeliveryBuffer alloc] initWithObservation:self limit:self.maximumPendingDeliveries overflowPolicy:self.deliveryOverflowPolicy maximumDelay:self.maximumDeliveryDelay];
+    TODeliveryBuffer *buffer = _deliveryBuffer;
+    
+    TOStripedLockUnlock(lockAddress);
+    
+    return buffer;
+}
+
+- (NSUInteger)droppedTriggerCount
+{
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    TODeliveryBuffer *buffer = _deliveryBuffer;
+    NSUInteger removedBuffersDroppedCount = _removedBuffersDroppedCount;
+    TOStripedLockUnlock(lockAddress);
+    
+    return removedBuffersDroppedCount + buffer.droppedCount;
+}
+
+- (nullable TORateLimiter *)rateLimiter
+{
+    if (self.rateLimit == TORateLimitNone || self.rateLimitInterval <= 0)
+        return nil;
+    
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    
+    if (_rateLimiter == nil) {
+        typeof(self) __weak welf = self;
+        _rateLimiter = [[TORateLimiter alloc] initWithRateLimit:self.rateLimit interval:self.rateLimitInterval handler:^(id trigger) {
+            if ([trigger isKindOfClass:[TOObservation class]])
+                [welf deliverEvent:trigger];
+            else
+                ((dispatch_block_t)trigger)();
+        }];
+    }
+    TORateLimiter *limiter = _rateLimiter;
+    
+    TOStripedLockUnlock(lockAddress);
+    
+    return limiter;
+}
+
+// returns YES if the rate limit dropped or held onto the trigger, in which case there's nothing more to do with it
+- (BOOL)rateLimitTriggerForEvent:(void(^)(id observation))setup
+{
+    TORateLimiter *limiter = [self rateLimiter];
+    if (limiter == nil)
+        return NO;
+    if (!limiter.holdsTriggers)
+        return ![limiter admitTrigger];
+    
+    TOObservation *event = [self dequeueEventCopy];
+    if (event == nil) {
+        return [self rateLimitTriggerAfter:^{
+            setup(self); // subclass doesn't make copies
+        } by:^{
+            [self invoke];
+        }];
+    }
+    setup(event);
+    event.triggerGeneration = atomic_load(&_generation);
+    id replaced = [limiter holdTrigger:event];
+    if ([replaced isKindOfClass:[TOObservation class]])
+        [self recycleEventCopy:replaced];
+    return YES;
+}
+
+- (BOOL)rateLimitTriggerAfter:(void(^)(void))setup by:(void(^)(void))invoke
+{
+    TORateLimiter *limiter = [self rateLimiter];
+    if (limiter == nil)
+        return NO;
+    if (!limiter.holdsTriggers)
+        return ![limiter admitTrigger];
+    
+    NSUInteger generation = atomic_load(&_generation);
+    [limiter holdTrigger:^{
+        if ([self isCurrentGeneration:generation])
+            [self deliverAfter:setup by:invoke];
+    }];
+    return YES;
+}
+
+static void TODrainDeliveryBuffer(void *context)
+{
+    // the buffer the triggers were added to, even if the observation has since replaced it or stopped using one
+    TODeliveryBuffer *buffer = (__bridge_transfer TODeliveryBuffer *)context;
+    TOObservation *observation = buffer.observation;
+    TOObservation *event;
+    while ((event = [buffer takeEvent]) != nil) {
+        [observation deliverEventCopy:event];
+    }
+}
+
+- (nullable TOObservation *)dequeueEventCopy
+{
+    TOObservation *event = nil;
+    
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    
+    event = _idleEventCopies.lastObject;
+    if (event != nil)
+        [_idleEventCopies removeLastObject];
+    
+    TOStripedLockUnlock(lockAddress);
+    
+    return event ?: [self eventCopy];
+}
+
+- (void)recycleEventCopy:(TOObservation *)event
+{
+    [event clearEvent]; // before locking, since this can release the last references to the trigger's values
+    
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    
+    if (_idleEventCopies == nil)
+        _idleEventCopies = [[NSMutableArray alloc] initWithCapacity:TO_IDLE_EVENT_COPIES_LIMIT];
+    if (_idleEventCopies.count < TO_IDLE_EVENT_COPIES_LIMIT)
+        [_idleEventCopies addObject:event];
+    
+    TOStripedLockUnlock(lockAddress);
+}
+
+- (void)invokeBatchWithEvent:(TOObservation *)event
+{
+    BOOL scheduleOpenBatch = NO;
+    BOOL scheduleClosedBatch = NO;
+    
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    
+    if (_openBatch == nil) {
+        _openBatch = [[NSMutableArray alloc] init];
+        scheduleOpenBatch = YES;
+    }
+    [_openBatch addObject:event];
+    if (self.maximumBatchSize > 0 && _openBatch.count >= self.maximumBatchSize) {
+        if (_closedBatches == nil)
+            _closedBatches = [[NSMutableArray alloc] init];
+        [_closedBatches addObject:_openBatch];
+        _openBatch = nil;
+        scheduleClosedBatch = YES;
+    }
+    
+    TOStripedLockUnlock(lockAddress);
+    
+    // every delivery takes the oldest batch waiting, so the extra one for a full batch may take a later open batch
+    // early, leaving nothing for that batch's own delivery when its latency is up
+    if (scheduleOpenBatch && !scheduleClosedBatch)
+        [self scheduleBatchDeliveryAfter:self.maximumBatchLatency];
+    if (scheduleClosedBatch)
+        [self scheduleBatchDeliveryAfter:0];
+}
+
+- (void)scheduleBatchDeliveryAfter:(NSTimeInterval)latency
+{
+    typeof(self) __weak welf = self;
+    if (latency > 0) {
+        dispatch_time_t when = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(latency * NSEC_PER_SEC));
+        dispatch_queue_t queue = self.directGCDQueue;
+        if (queue != nil) {
+            dispatch_after(when, queue, [self blockWithQualityOfService:^{
+                [welf deliverBatch];
+            }]);
+        }
+        else {
+            // then through the executor, like any other delivery
+            dispatch_after(when, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                [welf scheduleBatchDeliveryAfter:0];
+            });
+        }
+    }
+    else if (self.executor != nil) {
+        [self executeBlock:^{
+            [welf deliverBatch];
+        }];
+    }
+    else {
+        [self deliverBatch];
+    }
+}
+
+- (void)deliverBatch
+{
+    NSArray *batch = nil;
+    
+    const void *lockAddress = (__bridge const void *)self;
+    TOStripedLockLock(lockAddress);
+    
+    if (_closedBatches.count > 0) {
+        batch = _closedBatches.firstObject;
+        [_closedBatches removeObjectAtIndex:0];
+    }
+    else {
+        batch = _openBatch;
+        _openBatch = nil;
+    }
+    
+    TOStripedLockUnlock(lockAddress);
+    
+    if (batch.count > 0)
+        self.batchBlock(self.observer, batch);
+}
 
 - (void)invokeOnQueueAfter:(void(^)(void))setup
 {
@@ -161,18 +911,32 @@ static NSMutableSet *classesSwizzledSet = nil;
     [NSException raise:NSInternalInconsistencyException format:@"TOObservation registerInternal should not be called"];
 }
 
-- (NSString *)hashKey
+- (nullable instancetype)eventCopy
 {
-    [NSException raise:NSInternalInconsistencyException format:@"TOObservation hashKey should not be called"];
     return nil;
 }
 
+- (void)takeEventFromCopy:(TOObservation *)event
+{
+}
+
+- (void)clearEvent
+{
+}
+
+- (nullable NSString *)hashKey
+{
+    return nil; // subclasses that don't override this are stored unindexed, and can only be found with a linear search
+}
+
 
 #pragma mark -
 
 - (void)storeAssociatedObservation
 {
     NSAssert1(self.observer != nil || self.object != nil, @"Nil 'observer' & 'object' properties when storing observation %@", self);
+    [self prepareIndexKey];
+    
     // store into *both* observer & observee, although that may not be obvious
     // of course we want to remove the observation if the observer goes away, but also if the observee does too
     if (self.observer != nil)
@@ -181,9 +945,17 @@ static NSMutableSet *classesSwizzledSet = nil;
         [[self class] storeAssociatedObservation:self intoObject:self.object];
 }
 
+- (void)prepareIndexKey
+{
+    NSString *hashKey = [self hashKey];
+    self.indexKey = hashKey != nil ? [[self class] indexKeyForObserver:self.observer object:self.object hashKey:hashKey] : nil;
+}
+
 - (void)removeAssociatedObservation
 {
-    NSAssert1(self.observer != nil || self.object != nil, @"Nil 'observer' & 'object' properties when removing observation %@", self);
+    // during automatic removal the deallocating object's registry goes away with it, so only the other one (if any)
+    // needs the observation removed, for an anonymous observation that leaves nothing to do
+    NSAssert1(self.observer != nil || self.object != nil || self.removingAutomatically, @"Nil 'observer' & 'object' properties when removing observation %@", self);
     if (self.observer != nil)
         [[self class] removeAssociatedObservation:self fromObject:self.observer];
     if (self.object != nil && self.object != self.observer)
@@ -192,39 +964,19 @@ static NSMutableSet *classesSwizzledSet = nil;
 
 + (void)storeAssociatedObservation:(TOObservation *)observation intoObject:(id)associationTarget
 {
-    NSMutableSet *observationSet = nil;
-    @synchronized(associationTarget) {
-        
-        observationSet = objc_getAssociatedObject(associationTarget, &TOObservationSetKey);
-        if (observationSet == nil) {
-            observationSet = [NSMutableSet set];
-            objc_setAssociatedObject(associationTarget, &TOObservationSetKey, observationSet, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
-        }
-        
-    }
-    @synchronized(observationSet) {
-        
-        [observationSet addObject:observation];
-        
-    }
+    [TOObservationRegistry addObservation:observation toObject:associationTarget indexKey:observation.indexKey];
 }
 
 + (void)removeAssociatedObservation:(TOObservation *)observation fromObject:(id)associationTarget
 {
-    NSMutableSet *observationSet = nil;
-    @synchronized(associationTarget) {
-        
-        observationSet = objc_getAssociatedObject(associationTarget, &TOObservationSetKey);
-        
-    }
-    if (observationSet != nil) {
-        @synchronized(observationSet) {
-            
-            [observationSet removeObject:observation];
-            // don't bother removing the set when its empty, would have to use another @synchronized(associationTarget) block
-            
-        }
-    }
+    [TOObservationRegistry removeObservation:observation fromObject:associationTarget indexKey:observation.indexKey];
+}
+
++ (NSString *)indexKeyForObserver:(nullable id)observer object:(nullable id)object hashKey:(NSString *)hashKey
+{
+    // both pointers are part of the key because the same registry holds observations where its object is the
+    // observer as well as those where its the observee
+    return [NSString stringWithFormat:@"%p %p %@", observer, object, hashKey];
 }
 
 + (NSSet *)associatedObservationsForObserver:(id)observer
@@ -245,20 +997,7 @@ static NSMutableSet *classesSwizzledSet = nil;
 
 + (NSSet *)associatedObservationsForObject:(id)associationTarget
 {
-    NSMutableSet *observationSet = nil;
-    @synchronized(associationTarget) {
-        
-        observationSet = objc_getAssociatedObject(associationTarget, &TOObservationSetKey);
-        
-    }
-    if (observationSet != nil) {
-        @synchronized(observationSet) {
-            
-            observationSet = [observationSet copy];
-            
-        }
-    }
-    return observationSet;
+    return [TOObservationRegistry observationsInObject:associationTarget];
 }
 
 + (TOObservation *)findObservationForObserver:(nullable id)observer object:(nullable id)object matchingTest:(BOOL(^)(TOObservation *observation))testBlock
@@ -277,16 +1016,112 @@ static NSMutableSet *classesSwizzledSet = nil;
     return foundObservation;
 }
 
++ (nullable TOObservation *)findObservationForObserver:(nullable id)observer object:(nullable id)object hashKey:(NSString *)hashKey matchingTest:(nullable BOOL(^)(TOObservation *observation))testBlock
+{
+    NSParameterAssert(observer != nil || object != nil);
+    NSArray *candidates = [TOObservationRegistry observationsInObject:observer != nil ? observer : object forIndexKey:[self indexKeyForObserver:observer object:object hashKey:hashKey]];
+    
+    // normally just one candidate, more only if identical observations were made, or a stale one lingers from a
+    // deallocated object whose address got reused
+    for (TOObservation *observation in candidates) {
+        if ([observation isKindOfClass:self] && observer == observation.observer && object == observation.object && (testBlock == nil || testBlock(observation)))
+            return observation;
+    }
+    return nil;
+}
+
 
 #pragma mark -
 
++ (TOAutomaticRemovalMode)defaultAutomaticRemovalMode
+{
+    return defaultAutomaticRemovalMode;
+}
+
++ (void)setDefaultAutomaticRemovalMode:(TOAutomaticRemovalMode)mode
+{
+    defaultAutomaticRemovalMode = mode;
+}
+
++ (void)performWithAutomaticRemovalMode:(TOAutomaticRemovalMode)mode block:(void(^)(void))block
+{
+    [self currentAutomaticRemovalMode]; // ensures key is created
+    void *previousOverride = pthread_getspecific(automaticRemovalModeOverrideKey);
+    pthread_setspecific(automaticRemovalModeOverrideKey, (void *)(intptr_t)(mode + 1));
+    @try {
+        block();
+    }
+    @finally {
+        pthread_setspecific(automaticRemovalModeOverrideKey, previousOverride);
+    }
+}
+
++ (BOOL)shardsUnqueuedDeliveries
+{
+    return shardsUnqueuedDeliveries;
+}
+
++ (void)setShardsUnqueuedDeliveries:(BOOL)shards
+{
+    shardsUnqueuedDeliveries = shards;
+}
+
++ (BOOL)aggregatesQueuedDeliveries
+{
+    return aggregatesQueuedDeliveries;
+}
+
++ (void)setAggregatesQueuedDeliveries:(BOOL)aggregates
+{
+    aggregatesQueuedDeliveries = aggregates;
+}
+
++ (TOAutomaticRemovalMode)currentAutomaticRemovalMode
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&automaticRemovalModeOverrideKey, NULL);
+    });
+    intptr_t override = (intptr_t)pthread_getspecific(automaticRemovalModeOverrideKey);
+    return override != 0 ? (TOAutomaticRemovalMode)(override - 1) : defaultAutomaticRemovalMode;
+}
+
 - (void)adoptAutomaticRemoval
 {
     NSAssert1(self.observer != nil || self.object != nil, @"Nil 'observer' & 'object' properties when adopting auto-removal for observation %@", self);
-    if (self.observer != nil)
-        [[self class] swizzleDeallocIfNeededForClass:[self.observer class]];
-    if (self.object != nil && self.object != self.observer)
-        [[self class] swizzleDeallocIfNeededForClass:[self.object class]];
+    switch (self.automaticRemovalMode) {
+        case TOAutomaticRemovalModeSwizzleDealloc:
+            if (self.observer != nil)
+                [[self class] swizzleDeallocIfNeededForClass:[self.observer class]];
+            if (self.object != nil && self.object != self.observer)
+                [[self class] swizzleDeallocIfNeededForClass:[self.object class]];
+            break;
+        case TOAutomaticRemovalModeLifetimeSentinel:
+            if (self.observer != nil)
+                [[self class] attachLifetimeSentinelIfNeededToObject:self.observer];
+            if (self.object != nil && self.object != self.observer)
+                [[self class] attachLifetimeSentinelIfNeededToObject:self.object];
+            break;
+        case TOAutomaticRemovalModeNone:
+            break;
+    }
+}
+
++ (void)attachLifetimeSentinelIfNeededToObject:(id)object
+{
+    if (objc_getAssociatedObject(object, TOLifetimeSentinelKey) != nil)
+        return;
+    
+    // sentinel must be created after storing the observation, which is what creates the registry
+    TOLifetimeSentinel *sentinel = nil;
+    const void *lockAddress = (__bridge const void *)object;
+    TOStripedLockLock(lockAddress);
+    if (objc_getAssociatedObject(object, TOLifetimeSentinelKey) == nil) {
+        sentinel = [[TOLifetimeSentinel alloc] init];
+        sentinel.registry = [TOObservationRegistry registryForObject:object];
+        objc_setAssociatedObject(object, TOLifetimeSentinelKey, sentinel, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    TOStripedLockUnlock(lockAddress);
 }
 
 + (void)swizzleDeallocIfNeededForClass:(Class)class
@@ -296,36 +1131,51 @@ static NSMutableSet *classesSwizzledSet = nil;
         classesSwizzledSet = [NSMutableSet set];
     });
     
+    // every registration ends up here, so check without a lock first, only classes not seen before take the lock
+    if (TOSwizzledClassSlotsContain(class))
+        return;
+    
     // taken directly from _swizzleObjectClassIfNeeded in https://github.com/mikeash/MAKVONotificationCenter/blob/master/MAKVONotificationCenter.m
     
-    @synchronized(classesSwizzledSet) {
-        
-        if (![classesSwizzledSet containsObject:class]) {
-            // here be dragons
-            SEL deallocSel = NSSelectorFromString(@"dealloc");
-            Method dealloc = class_getInstanceMethod(class, deallocSel);
-            IMP origImpl = method_getImplementation(dealloc);
-            IMP newImpl = imp_implementationWithBlock(^(void *obj) { // MAKVONotificationCenter casts its block to (__bridge void *), but that's giving error here :(
+    const void *lockAddress = (__bridge const void *)classesSwizzledSet;
+    TOStripedLockLock(lockAddress);
+    if (![classesSwizzledSet containsObject:class]) {
+        // here be dragons
+        SEL deallocSel = NSSelectorFromString(@"dealloc");
+        Method dealloc = class_getInstanceMethod(class, deallocSel);
+        IMP origImpl = method_getImplementation(dealloc);
+        IMP newImpl = imp_implementationWithBlock(^(void *obj) { // MAKVONotificationCenter casts its block to (__bridge void *), but that's giving error here :(
+            // instances that were never observed go straight to the original dealloc
+            if (TOObservationRegistryExistsForObject(obj)) {
                 @autoreleasepool {
                     [TOObservation performAutomaticRemovalForObject:(__bridge id)obj];
                 }
-                ((void (*)(void *, SEL))origImpl)(obj, deallocSel);
-            });
-            
-            class_replaceMethod(class, deallocSel, newImpl, method_getTypeEncoding(dealloc));
-            
-            [classesSwizzledSet addObject:class];
-        }
+            }
+            ((void (*)(void *, SEL))origImpl)(obj, deallocSel);
+        });
         
+        class_replaceMethod(class, deallocSel, newImpl, method_getTypeEncoding(dealloc));
+        
+        [classesSwizzledSet addObject:class];
+        TOSwizzledClassSlotsInsert(class);
     }
+    TOStripedLockUnlock(lockAddress);
 }
 
 + (void)performAutomaticRemovalForObject:(id)objectBeingDeallocated
 {
     NSSet *observationSet = [self associatedObservationsForObject:objectBeingDeallocated]; // observations both by the object & on the object
+    [self performAutomaticRemovalForObservations:observationSet];
+}
+
++ (void)performAutomaticRemovalForObservations:(nullable NSSet *)observationSet
+{
     for (TOObservation *observation in observationSet) {
-        if (observation.removeAutomatically)
+        if (observation.removeAutomatically) {
+            observation.removingAutomatically = YES;
             [observation remove];
+            observation.removingAutomatically = NO;
+        }
     }
 }
 
@@ -0,0 +1,29 @@
+//
+//  TOObservationBag+Private.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOObservationBag.h"
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#endif
+
+@interface TOObservationBag (PrivateForObservationToUse)
+/**
+ *  If the current thread is within a bag's `addObservationsWithBlock:`, add the observation to that bag, which
+ *  takes over storing the observation into its observer & observee and adopting automatic removal.
+ *
+ *  @param observation An observation that's being registered.
+ *
+ *  @return `YES` if the observation was deferred to a bag, `NO` if the caller needs to store it itself.
+ */
++ (BOOL)deferStoringObservation:(TOObservation *)observation;
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
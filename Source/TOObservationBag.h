@@ -0,0 +1,71 @@
+//
+//  TOObservationBag.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#define TO_nullable nullable
+#else
+#define TO_nullable
+#endif
+
+@class TOObservation;
+
+/**
+ *  A group of observations which are removed all at once, either explicitly by `removeAll` or when the bag is
+ *  deallocated. Useful for an object which makes many observations together and tears them down together, such as
+ *  a view model or a reused table cell.
+ *
+ *  Observations created within `addObservationsWithBlock:` are not only added to the bag, but are also stored
+ *  into their observers and observees all together after the block returns, in a single transaction per object
+ *  instead of one for each observation. Removal by the bag is likewise done in a single transaction per object.
+ *
+ *  A bag isn't thread safe, use each one from a single thread at a time.
+ */
+@interface TOObservationBag : NSObject
+
+/**
+ *  The observations in the bag, in the order they were added. Includes any that have since been removed
+ *  individually or automatically, until `removeAll` is called. (read-only)
+ */
+@property (nonatomic, readonly) NSArray *observations;
+
+/**
+ *  Call a block and add every observation it creates on the current thread to the bag.
+ *
+ *  Until the block returns, observations created within it are registered and will trigger, but aren't yet stored
+ *  into their observer or observee, so can't yet be found and removed by `to_stopObserving...` methods, nor be
+ *  removed automatically. They can still be removed using the observation object itself.
+ *
+ *  Calls can be nested, including with different bags, observations are only added to the innermost one.
+ *
+ *  @param block A block which calls `to_observe...` methods.
+ */
+- (void)addObservationsWithBlock:(void(^)(void))block;
+
+/**
+ *  Add an observation created outside of `addObservationsWithBlock:` to the bag, so that it's removed along with
+ *  the others.
+ *
+ *  @param observation The observation to add.
+ */
+- (void)addObservation:(TOObservation *)observation;
+
+/**
+ *  Remove all observations in the bag that are still registered, and empty the bag. Called automatically when the
+ *  bag is deallocated.
+ */
+- (void)removeAll;
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
+#undef TO_nullable
@@ -0,0 +1,183 @@
+//
+//  TOObservationBag.m
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOObservationBag.h"
+#import "TOObservationBag+Private.h"
+#import "TOObservation+Private.h"
+#import "TOObservationRegistry.h"
+#import <pthread.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#else
+#define nullable
+#endif
+
+@interface TOObservationBag ()
+@property (nonatomic) NSMutableArray *mutableObservations;
+@property (nonatomic, nullable) NSMutableArray *deferredObservations; // created within addObservationsWithBlock: & not yet stored
+@end
+
+static pthread_key_t TOCurrentBagKey(void)
+{
+    static pthread_key_t currentBagKey; // bag within whose addObservationsWithBlock: the thread is, unretained
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&currentBagKey, NULL);
+    });
+    return currentBagKey;
+}
+
+// keyed by object identity, since observed objects may have overridden isEqual:
+static NSMapTable *TOObservationsByTargetMapTable(void)
+{
+    return [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                     valueOptions:NSPointerFunctionsStrongMemory capacity:0];
+}
+
+static void TOAddObservationForTarget(NSMapTable *observationsByTarget, TOObservation *observation, id target)
+{
+    NSMutableArray *observations = [observationsByTarget objectForKey:target];
+    if (observations == nil) {
+        observations = [NSMutableArray array];
+        [observationsByTarget setObject:observations forKey:target];
+    }
+    [observations addObject:observation];
+}
+
+
+#pragma mark -
+
+@implementation TOObservationBag
+
+- (instancetype)init
+{
+    if (!(self = [super init]))
+        return nil;
+    _mutableObservations = [[NSMutableArray alloc] init];
+    return self;
+}
+
+- (void)dealloc
+{
+    [self removeAll];
+}
+
+- (NSArray *)observations
+{
+    return [self.mutableObservations copy];
+}
+
+- (void)addObservationsWithBlock:(void(^)(void))block
+{
+    pthread_key_t key = TOCurrentBagKey();
+    void *previousBag = pthread_getspecific(key);
+    if (previousBag == (__bridge void *)self) {
+        block(); // nested within this same bag, outermost call does the storing
+        return;
+    }
+
+    self.deferredObservations = [NSMutableArray array];
+    pthread_setspecific(key, (__bridge void *)self);
+    @try {
+        block();
+    }
+    @finally {
+        // even if the block throws, since the key doesn't retain this bag and what it registered is still registered
+        pthread_setspecific(key, previousBag);
+
+        NSArray *deferredObservations = self.deferredObservations;
+        self.deferredObservations = nil;
+        [self storeObservations:deferredObservations];
+    }
+}
+
+- (void)addObservation:(TOObservation *)observation
+{
+    [self.mutableObservations addObject:observation];
+}
+
++ (BOOL)deferStoringObservation:(TOObservation *)observation
+{
+    TOObservationBag *bag = (__bridge TOObservationBag *)pthread_getspecific(TOCurrentBagKey());
+    if (bag == nil)
+        return NO;
+
+    [bag.mutableObservations addObject:observation];
+    [bag.deferredObservations addObject:observation];
+    return YES;
+}
+
+- (void)storeObservations:(NSArray *)observations
+{
+    // same as -[TOObservation storeAssociatedObservation] but grouped by object, so each is changed just once
+    NSMapTable *observationsByTarget = TOObservationsByTargetMapTable();
+    NSMutableArray *storedObservations = [NSMutableArray arrayWithCapacity:observations.count];
+    for (TOObservation *observation in observations) {
+        if (!observation.registered)
+            continue; // removed already using the observation itself
+
+        id observer = observation.observer;
+        id object = observation.object;
+        if (observer == nil && object == nil) {
+            // both went away before the block returned, so nothing was left to remove it automatically
+            [observation deregisterForRemoval];
+            continue;
+        }
+
+        [observation prepareIndexKey];
+        if (observer != nil)
+            TOAddObservationForTarget(observationsByTarget, observation, observer);
+        if (object != nil && object != observer)
+            TOAddObservationForTarget(observationsByTarget, observation, object);
+        [storedObservations addObject:observation];
+    }
+
+    for (id target in observationsByTarget) {
+        [TOObservationRegistry addObservations:[observationsByTarget objectForKey:target] toObject:target];
+    }
+
+    // automatic removal is adopted only once the observations are stored, as in -[TOObservation register]
+    for (TOObservation *observation in storedObservations) {
+        [observation adoptAutomaticRemoval];
+    }
+}
+
+- (void)removeAll
+{
+    NSArray *observations = [self.mutableObservations copy]; // keeps them alive until removed from every object
+    [self.mutableObservations removeAllObjects];
+
+    // same as -[TOObservation remove] but grouped by object, so each is changed just once
+    NSMapTable *observationsByTarget = TOObservationsByTargetMapTable();
+    for (TOObservation *observation in observations) {
+        if (!observation.registered)
+            continue;
+
+        [observation deregisterForRemoval];
+
+        id observer = observation.observer;
+        id object = observation.object;
+        if (observer != nil)
+            TOAddObservationForTarget(observationsByTarget, observation, observer);
+        if (object != nil && object != observer)
+            TOAddObservationForTarget(observationsByTarget, observation, object);
+    }
+
+    for (id target in observationsByTarget) {
+        [TOObservationRegistry removeObservations:[observationsByTarget objectForKey:target] fromObject:target];
+    }
+}
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#else
+#undef nullable
+#endif
@@ -0,0 +1,99 @@
+//
+//  TOObservationRegistry.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+//  Per-object container for the observations stored into an observer or observee, attached as an associated
+//  object. Besides the set of all observations, keeps an index keyed by a canonical key so that an observation
+//  can be found again from its creation parameters without walking the whole set.
+//
+//  Every change takes the striped lock for the object it's attached to exactly once, see TOStripedLock.h.
+//  Readers are handed immutable values: index buckets are replaced rather than mutated, and the set of all
+//  observations is published as an immutable snapshot that's dropped on each change and rebuilt by the next
+//  reader. Changes themselves stay O(1), so a run of removals doesn't copy the set each time, while a run of
+//  reads, such as automatic removal on dealloc, copies nothing and takes no striped lock.
+
+#import <Foundation/Foundation.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#define TO_nullable nullable
+#else
+#define TO_nullable
+#endif
+
+@class TOObservation;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Whether a registry was attached to the object at the given address and hasn't been deallocated yet. Exact, kept
+ *  in a side table keyed by address rather than looked up as an associated object. Takes one atomic load and no lock
+ *  while no object sharing the address's shard has a registry, and otherwise one uncontended mutex, meant for paths
+ *  like dealloc that run for every instance of a class whether or not it was observed.
+ */
+BOOL TOObservationRegistryExistsForObject(const void *address);
+
+#ifdef __cplusplus
+}
+#endif
+
+@interface TOObservationRegistry : NSObject
+
+/**
+ *  Add an observation to the registry attached to the given object, creating and attaching the registry first
+ *  if needed. Also adds the observation to the index if `indexKey` is not `nil`.
+ */
++ (void)addObservation:(TOObservation *)observation toObject:(id)associationTarget indexKey:(TO_nullable NSString *)indexKey;
+
+/**
+ *  Add several observations to the registry attached to the given object, changing it in a single transaction
+ *  rather than once per observation. Each is indexed using its own `indexKey`.
+ */
++ (void)addObservations:(NSArray *)observations toObject:(id)associationTarget;
+
+/**
+ *  Remove an observation from the registry attached to the given object, also removing it from the index if
+ *  `indexKey` is not `nil`. This must be the same key used when the observation was added.
+ */
++ (void)removeObservation:(TOObservation *)observation fromObject:(id)associationTarget indexKey:(TO_nullable NSString *)indexKey;
+
+/**
+ *  Remove several observations from the registry attached to the given object in a single transaction, see
+ *  `addObservations:toObject:`.
+ */
++ (void)removeObservations:(NSArray *)observations fromObject:(id)associationTarget;
+
+/**
+ *  The observations added to the given object with the given index key, in the order they were added, or `nil`
+ *  if there are none. The result is immutable and isn't a copy.
+ */
++ (TO_nullable NSArray *)observationsInObject:(id)associationTarget forIndexKey:(NSString *)indexKey;
+
+/**
+ *  An immutable snapshot of the set of all observations added to the given object, or `nil` if none were ever
+ *  added. Only makes a copy if the observations have changed since the last snapshot was taken.
+ */
++ (TO_nullable NSSet *)observationsInObject:(id)associationTarget;
+
+/**
+ *  The registry attached to the given object, or `nil` if no observation was ever added to it. Only needed to keep
+ *  the registry beyond the object's lifetime, to get at its observations while the object is being deallocated.
+ */
++ (TO_nullable instancetype)registryForObject:(id)associationTarget;
+
+/**
+ *  An immutable snapshot of the set of all observations in the receiver, see `observationsInObject:`.
+ */
+- (NSSet *)observationSnapshot;
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
+#undef TO_nullable
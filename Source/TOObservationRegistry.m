@@ -0,0 +1,243 @@
+//
+//  TOObservationRegistry.m
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOObservationRegistry.h"
+#import "TOObservation+Private.h"
+#import "TOStripedLock.h"
+#import <objc/runtime.h>
+#import <pthread.h>
+#import <stdatomic.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#else
+#define nullable
+#endif
+
+static const int TOObservationRegistryKeyVar;
+static void *TOObservationRegistryKey = (void *)&TOObservationRegistryKeyVar;
+
+// the exact addresses of objects with live registries, sharded by address so that unrelated objects rarely share a
+// lock, and counted since a registry kept past its object's dealloc can overlap with one for a new object at the
+// same address
+#define TO_REGISTRY_SHARD_COUNT 64 // must be a power of 2
+
+typedef struct {
+    pthread_mutex_t mutex;
+    _Atomic(NSUInteger) count; // lets lookups in a shard with no registries skip the mutex
+    CFMutableBagRef addresses; // compared by pointer, never dereferenced
+} TORegistryShard;
+
+static TORegistryShard registryShards[TO_REGISTRY_SHARD_COUNT];
+
+static TORegistryShard *TORegistryShardForAddress(const void *address)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        for (NSUInteger i = 0; i < TO_REGISTRY_SHARD_COUNT; ++i) {
+            pthread_mutex_init(&registryShards[i].mutex, NULL);
+            registryShards[i].addresses = CFBagCreateMutable(kCFAllocatorDefault, 0, NULL);
+        }
+    });
+    uintptr_t bits = (uintptr_t)address;
+    return &registryShards[((bits >> 4) ^ (bits >> 10)) & (TO_REGISTRY_SHARD_COUNT - 1)];
+}
+
+static void TORegistryShardsAddAddress(const void *address)
+{
+    TORegistryShard *shard = TORegistryShardForAddress(address);
+    pthread_mutex_lock(&shard->mutex);
+    CFBagAddValue(shard->addresses, address);
+    atomic_fetch_add_explicit(&shard->count, 1, memory_order_release);
+    pthread_mutex_unlock(&shard->mutex);
+}
+
+static void TORegistryShardsRemoveAddress(const void *address)
+{
+    TORegistryShard *shard = TORegistryShardForAddress(address);
+    pthread_mutex_lock(&shard->mutex);
+    CFBagRemoveValue(shard->addresses, address);
+    atomic_fetch_sub_explicit(&shard->count, 1, memory_order_release);
+    pthread_mutex_unlock(&shard->mutex);
+}
+
+BOOL TOObservationRegistryExistsForObject(const void *address)
+{
+    TORegistryShard *shard = TORegistryShardForAddress(address);
+    if (atomic_load_explicit(&shard->count, memory_order_acquire) == 0)
+        return NO;
+    pthread_mutex_lock(&shard->mutex);
+    BOOL exists = CFBagContainsValue(shard->addresses, address);
+    pthread_mutex_unlock(&shard->mutex);
+    return exists;
+}
+
+@interface TOObservationRegistry ()
+@property (nonatomic) NSMutableSet *observations;
+@property (nonatomic) NSMutableDictionary *index; // {indexKey: [observation, ..]}, buckets are immutable and replaced when changed
+@property (atomic, nullable) NSSet *snapshot;     // immutable copy of observations, cleared when they change and rebuilt on demand
+@property (nonatomic) const void *targetAddress;  // only used for its shard & striped lock, never dereferenced
+@end
+
+@implementation TOObservationRegistry
+
+- (instancetype)initWithTargetAddress:(const void *)targetAddress
+{
+    if (!(self = [super init]))
+        return nil;
+    _observations = [[NSMutableSet alloc] init];
+    _index = [[NSMutableDictionary alloc] init];
+    _targetAddress = targetAddress;
+    TORegistryShardsAddAddress(targetAddress);
+    return self;
+}
+
+- (void)dealloc
+{
+    // associated objects are released after the swizzled dealloc has checked for a registry, so it's always found then
+    TORegistryShardsRemoveAddress(_targetAddress);
+}
+
++ (void)addObservation:(TOObservation *)observation toObject:(id)associationTarget indexKey:(nullable NSString *)indexKey
+{
+    const void *lockAddress = (__bridge const void *)associationTarget;
+    TOStripedLockLock(lockAddress);
+
+    [[self lockedRegistryCreatingForObject:associationTarget] lockedAddObservation:observation indexKey:indexKey];
+
+    TOStripedLockUnlock(lockAddress);
+}
+
++ (void)addObservations:(NSArray *)observations toObject:(id)associationTarget
+{
+    const void *lockAddress = (__bridge const void *)associationTarget;
+    TOStripedLockLock(lockAddress);
+
+    TOObservationRegistry *registry = [self lockedRegistryCreatingForObject:associationTarget];
+    for (TOObservation *observation in observations) {
+        [registry lockedAddObservation:observation indexKey:observation.indexKey];
+    }
+
+    TOStripedLockUnlock(lockAddress);
+}
+
++ (void)removeObservation:(TOObservation *)observation fromObject:(id)associationTarget indexKey:(nullable NSString *)indexKey
+{
+    // if the registry held the last reference, make sure the observation isn't deallocated while holding the lock
+    TOObservation *retainedObservation NS_VALID_UNTIL_END_OF_SCOPE = observation;
+
+    const void *lockAddress = (__bridge const void *)associationTarget;
+    TOStripedLockLock(lockAddress);
+
+    // don't bother removing the registry when its empty, it goes away along with the object
+    TOObservationRegistry *registry = objc_getAssociatedObject(associationTarget, TOObservationRegistryKey);
+    [registry lockedRemoveObservation:retainedObservation indexKey:indexKey];
+
+    TOStripedLockUnlock(lockAddress);
+}
+
++ (void)removeObservations:(NSArray *)observations fromObject:(id)associationTarget
+{
+    // the array keeps the observations alive while holding the lock, the same as the single removal above
+    const void *lockAddress = (__bridge const void *)associationTarget;
+    TOStripedLockLock(lockAddress);
+
+    TOObservationRegistry *registry = objc_getAssociatedObject(associationTarget, TOObservationRegistryKey);
+    for (TOObservation *observation in observations) {
+        [registry lockedRemoveObservation:observation indexKey:observation.indexKey];
+    }
+
+    TOStripedLockUnlock(lockAddress);
+}
+
+// methods prefixed by "locked" must be called with the target's striped lock held
+
++ (TOObservationRegistry *)lockedRegistryCreatingForObject:(id)associationTarget
+{
+    TOObservationRegistry *registry = objc_getAssociatedObject(associationTarget, TOObservationRegistryKey);
+    if (registry == nil) {
+        registry = [[self alloc] initWithTargetAddress:(__bridge const void *)associationTarget];
+        objc_setAssociatedObject(associationTarget, TOObservationRegistryKey, registry, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    return registry;
+}
+
+- (void)lockedAddObservation:(TOObservation *)observation indexKey:(nullable NSString *)indexKey
+{
+    [self.observations addObject:observation];
+    self.snapshot = nil;
+    if (indexKey != nil) {
+        NSArray *bucket = self.index[indexKey];
+        self.index[indexKey] = bucket != nil ? [bucket arrayByAddingObject:observation] : @[observation];
+    }
+}
+
+- (void)lockedRemoveObservation:(TOObservation *)observation indexKey:(nullable NSString *)indexKey
+{
+    [self.observations removeObject:observation];
+    self.snapshot = nil;
+    NSArray *bucket = indexKey != nil ? self.index[indexKey] : nil;
+    if (bucket != nil) {
+        NSMutableArray *newBucket = [bucket mutableCopy];
+        [newBucket removeObjectIdenticalTo:observation];
+        if (newBucket.count > 0)
+            self.index[indexKey] = [newBucket copy];
+        else
+            [self.index removeObjectForKey:indexKey];
+    }
+}
+
++ (nullable NSArray *)observationsInObject:(id)associationTarget forIndexKey:(NSString *)indexKey
+{
+    const void *lockAddress = (__bridge const void *)associationTarget;
+    TOStripedLockLock(lockAddress);
+
+    TOObservationRegistry *registry = objc_getAssociatedObject(associationTarget, TOObservationRegistryKey);
+    NSArray *bucket = registry.index[indexKey]; // immutable, safe to use after unlocking without copying
+
+    TOStripedLockUnlock(lockAddress);
+    return bucket;
+}
+
++ (nullable NSSet *)observationsInObject:(id)associationTarget
+{
+    return [[self registryForObject:associationTarget] observationSnapshot];
+}
+
++ (nullable instancetype)registryForObject:(id)associationTarget
+{
+    return objc_getAssociatedObject(associationTarget, TOObservationRegistryKey);
+}
+
+- (NSSet *)observationSnapshot
+{
+    // common case is a snapshot is already published, reading it takes one atomic load, no copy & no striped lock
+    NSSet *snapshot = self.snapshot;
+    if (snapshot != nil)
+        return snapshot;
+
+    // target may be mid-dealloc, only its address is used here, same as the lock taken when it was alive
+    TOStripedLockLock(self.targetAddress);
+
+    snapshot = self.snapshot;
+    if (snapshot == nil) {
+        snapshot = [self.observations copy];
+        self.snapshot = snapshot;
+    }
+
+    TOStripedLockUnlock(self.targetAddress);
+    return snapshot;
+}
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#else
+#undef nullable
+#endif
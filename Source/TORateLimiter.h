@@ -0,0 +1,64 @@
+//
+//  TORateLimiter.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+//  Applies an observation's `rateLimit` to its triggers before they're given to its executor. A leading throttle
+//  just admits or suppresses each trigger. Other limits hold onto the latest trigger, replacing any held before it,
+//  and pass it to a handler when a timer fires.
+
+#import <Foundation/Foundation.h>
+#import "TOObservation.h"
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#define TO_nullable nullable
+#else
+#define TO_nullable
+#endif
+
+@interface TORateLimiter : NSObject
+
+/**
+ *  Initializes and returns a rate limiter.
+ *
+ *  @param rateLimit The kind of limit, not `TORateLimitNone`.
+ *  @param interval  The interval of the limit, greater than 0.
+ *  @param handler   Called with each trigger released by the limit, on a global queue.
+ */
+- (instancetype)initWithRateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval handler:(void(^)(id trigger))handler;
+
+/**
+ *  Whether triggers are given to `holdTrigger:`, otherwise to `admitTrigger`. (read-only)
+ */
+@property (nonatomic, readonly) BOOL holdsTriggers;
+
+/**
+ *  For a leading throttle, whether a trigger occurring now is delivered, starting a new interval if so. Lock-free.
+ */
+- (BOOL)admitTrigger;
+
+/**
+ *  Hold a trigger to pass to the handler once the limit allows, arming the timer if needed.
+ *
+ *  @param trigger An event copy, or a block to call.
+ *
+ *  @return The trigger that was held before, which is replaced and won't be passed to the handler.
+ */
+- (TO_nullable id)holdTrigger:(id)trigger;
+
+/**
+ *  Stop holding any trigger, such as when its observation is removed.
+ *
+ *  @return The trigger that was held, which won't be passed to the handler.
+ */
+- (TO_nullable id)removeHeldTrigger;
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
+#undef TO_nullable
@@ -0,0 +1,161 @@
+//
+//  TORateLimiter.m
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TORateLimiter.h"
+#import "TOTimerWheel.h"
+#import "TOTime.h"
+#import <pthread.h>
+#import <stdatomic.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#else
+#define nullable
+#endif
+
+
+@interface TORateLimiter ()
+- (void)fire;
+@end
+
+static void TOFireRateLimiter(void *context)
+{
+    TORateLimiter *limiter = (__bridge_transfer TORateLimiter *)context;
+    [limiter fire];
+}
+
+
+@implementation TORateLimiter {
+    TORateLimit _rateLimit;
+    uint64_t _interval; // in nanoseconds
+    void (^_handler)(id trigger);
+    _Atomic(uint64_t) _nextAdmitTime; // leading throttle only
+    
+    pthread_mutex_t _mutex;
+    TOWheelTimer *_timer;     // all but leading throttle
+    id _heldTrigger;          // guarded by _mutex
+    BOOL _timerArmed;         // guarded by _mutex
+    uint64_t _dueTime;        // guarded by _mutex, when the timer was last armed to fire
+    uint64_t _sampleOrigin;   // guarded by _mutex, time of the first trigger sampled, ticks are whole intervals after it
+}
+
+- (instancetype)initWithRateLimit:(TORateLimit)rateLimit interval:(NSTimeInterval)interval handler:(void(^)(id trigger))handler
+{
+    NSParameterAssert(rateLimit != TORateLimitNone && interval > 0);
+    if (!(self = [super init]))
+        return nil;
+    _rateLimit = rateLimit;
+    _interval = (uint64_t)(interval * NSEC_PER_SEC);
+    _handler = [handler copy];
+    pthread_mutex_init(&_mutex, NULL);
+    
+    if (self.holdsTriggers) {
+        typeof(self) __weak welf = self;
+        _timer = [[TOTimerWheel sharedWheel] timerWithBlock:^{
+            // off the wheel's thread, since delivering can call the observation's block
+            TORateLimiter *limiter = welf;
+            if (limiter != nil)
+                dispatch_async_f(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), (__bridge_retained void *)limiter, TOFireRateLimiter);
+        }];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_timer != nil)
+        [[TOTimerWheel sharedWheel] cancelTimer:_timer];
+    pthread_mutex_destroy(&_mutex);
+}
+
+- (BOOL)holdsTriggers
+{
+    return _rateLimit != TORateLimitThrottleLeading;
+}
+
+- (BOOL)admitTrigger
+{
+    uint64_t now = TONanosecondsNow();
+    uint64_t next = atomic_load(&_nextAdmitTime);
+    // of triggers racing to start the same interval, only one succeeds in moving it along
+    return now >= next && atomic_compare_exchange_strong(&_nextAdmitTime, &next, now + _interval);
+}
+
+- (nullable id)holdTrigger:(id)trigger
+{
+    id replaced = nil;
+    uint64_t now = TONanosecondsNow();
+    
+    pthread_mutex_lock(&_mutex);
+    
+    replaced = _heldTrigger;
+    _heldTrigger = trigger;
+    int64_t delay = -1;
+    switch (_rateLimit) {
+        case TORateLimitDebounce:
+            delay = _interval; // pushed back by every trigger
+            break;
+        case TORateLimitThrottleTrailing:
+            if (!_timerArmed)
+                delay = _interval; // counted from the first trigger since the last delivery
+            break;
+        case TORateLimitSample:
+            if (!_timerArmed) {
+                if (_sampleOrigin == 0)
+                    _sampleOrigin = now;
+                delay = _interval - (now - _sampleOrigin) % _interval; // the next tick at the fixed rate
+            }
+            break;
+        default:
+            break;
+    }
+    if (delay >= 0) {
+        _timerArmed = YES;
+        _dueTime = now + (uint64_t)delay;
+        [[TOTimerWheel sharedWheel] scheduleTimer:_timer after:(NSTimeInterval)delay / NSEC_PER_SEC];
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    return replaced;
+}
+
+- (nullable id)removeHeldTrigger
+{
+    pthread_mutex_lock(&_mutex);
+    id removed = _heldTrigger;
+    _heldTrigger = nil;
+    pthread_mutex_unlock(&_mutex);
+    return removed;
+}
+
+- (void)fire
+{
+    pthread_mutex_lock(&_mutex);
+    if (TONanosecondsNow() < _dueTime) {
+        // fired for an earlier arming but armed again before getting here, such as by a debounced trigger, so
+        // leave the trigger for the firing that arming is due to cause, which the wheel never makes early
+        pthread_mutex_unlock(&_mutex);
+        return;
+    }
+    id trigger = _heldTrigger;
+    _heldTrigger = nil;
+    _timerArmed = NO;
+    pthread_mutex_unlock(&_mutex);
+    
+    if (trigger != nil)
+        _handler(trigger);
+}
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#else
+#undef nullable
+#endif
@@ -0,0 +1,35 @@
+//
+//  TOStripedLock.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+//  A fixed array of lightweight non-recursive locks, each padded to its own cache line, selected by hashing an
+//  address. Used instead of @synchronized, which goes through the runtime's global table of recursive mutexes
+//  and is noticeably slower when many threads register and remove observations at once.
+//
+//  Because the locks aren't recursive and unrelated addresses can share a stripe, code must never take a striped
+//  lock while already holding one, and must not call out to arbitrary code (or let the last reference to an
+//  object go away) while holding one.
+
+#import <Foundation/Foundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Acquire the lock for the stripe that the given address hashes to.
+ */
+void TOStripedLockLock(const void *address);
+
+/**
+ *  Release the lock for the stripe that the given address hashes to, previously acquired by `TOStripedLockLock`
+ *  with the same address.
+ */
+void TOStripedLockUnlock(const void *address);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,67 @@
+//
+//  TOStripedLock.m
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOStripedLock.h"
+
+// os_unfair_lock when the deployment target is new enough to have it, otherwise a default (non-recursive)
+// pthread mutex, which also stays in user space when uncontended
+#if (defined(__IPHONE_OS_VERSION_MIN_REQUIRED) && __IPHONE_OS_VERSION_MIN_REQUIRED >= 100000) || (defined(__MAC_OS_X_VERSION_MIN_REQUIRED) && __MAC_OS_X_VERSION_MIN_REQUIRED >= 101200)
+#define TO_USE_UNFAIR_LOCK 1
+#import <os/lock.h>
+#else
+#define TO_USE_UNFAIR_LOCK 0
+#import <pthread.h>
+#endif
+
+#define TO_STRIPE_COUNT 64   // must be a power of 2
+#define TO_CACHE_LINE_SIZE 64
+
+typedef struct {
+#if TO_USE_UNFAIR_LOCK
+    os_unfair_lock lock;
+#else
+    pthread_mutex_t lock;
+#endif
+} __attribute__((aligned(TO_CACHE_LINE_SIZE))) TOLockStripe;
+
+static TOLockStripe lockStripes[TO_STRIPE_COUNT];
+
+static inline TOLockStripe *TOLockStripeForAddress(const void *address)
+{
+    // objects are at least 16-byte aligned so the low bits carry nothing, fold in some higher bits too
+    uintptr_t bits = (uintptr_t)address;
+    return &lockStripes[((bits >> 4) ^ (bits >> 10)) & (TO_STRIPE_COUNT - 1)];
+}
+
+#if !TO_USE_UNFAIR_LOCK
+__attribute__((constructor))
+static void TOLockStripesInitialize(void)
+{
+    for (int i = 0; i < TO_STRIPE_COUNT; ++i) {
+        pthread_mutex_init(&lockStripes[i].lock, NULL);
+    }
+}
+#endif
+
+void TOStripedLockLock(const void *address)
+{
+#if TO_USE_UNFAIR_LOCK
+    os_unfair_lock_lock(&TOLockStripeForAddress(address)->lock);
+#else
+    pthread_mutex_lock(&TOLockStripeForAddress(address)->lock);
+#endif
+}
+
+void TOStripedLockUnlock(const void *address)
+{
+#if TO_USE_UNFAIR_LOCK
+    os_unfair_lock_unlock(&TOLockStripeForAddress(address)->lock);
+#else
+    pthread_mutex_unlock(&TOLockStripeForAddress(address)->lock);
+#endif
+}
@@ -0,0 +1,25 @@
+//
+//  TOTime.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+//  Monotonic time shared by the timer wheel and the rate limiters and watchdogs scheduled on it, so that their
+//  timestamps can be compared with each other.
+
+#import <Foundation/Foundation.h>
+#import <mach/mach_time.h>
+
+/**
+ *  The current mach absolute time converted to nanoseconds.
+ */
+static inline uint64_t TONanosecondsNow(void)
+{
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+}
@@ -0,0 +1,89 @@
+//
+//  TOTimerWheel.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+//  Hierarchical timing wheel shared by all of an app's timed observation features, such as `rateLimit` and
+//  watchdogs, so that hundreds of thousands of observations don't each need their own timer source. Scheduling,
+//  rescheduling and cancelling a timer are constant time. Timers fire on the wheel's single background thread, which
+//  sleeps until the next timer is due, so their blocks should only hand work off elsewhere.
+//
+//  Timers fire no earlier than scheduled, and normally within the wheel's resolution after that.
+
+#import <Foundation/Foundation.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#define TO_nullable nullable
+#else
+#define TO_nullable
+#endif
+
+/**
+ *  A timer on a `TOTimerWheel`, created once and then scheduled any number of times. The wheel keeps a strong
+ *  reference to a timer only while it's scheduled.
+ */
+@interface TOWheelTimer : NSObject
+
+/**
+ *  Whether the timer is scheduled and hasn't fired or been cancelled since. (read-only)
+ */
+@property (nonatomic, readonly) BOOL scheduled;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+
+@interface TOTimerWheel : NSObject
+
+/**
+ *  The shared instance, with a resolution of 1 millisecond, its thread started when first needed.
+ */
++ (instancetype)sharedWheel;
+
+/**
+ *  Initializes and returns a wheel. Its thread is started with the first timer scheduled, and exits once the wheel is
+ *  deallocated.
+ *
+ *  @param resolution The duration of one tick of the wheel, greater than 0.
+ */
+- (instancetype)initWithResolution:(NSTimeInterval)resolution NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  The duration of one tick of the wheel. (read-only)
+ */
+@property (nonatomic, readonly) NSTimeInterval resolution;
+
+/**
+ *  A new timer for the receiver, not yet scheduled.
+ *
+ *  @param block Called on the wheel's thread each time the timer fires. Can schedule the timer again.
+ */
+- (TOWheelTimer *)timerWithBlock:(dispatch_block_t)block;
+
+/**
+ *  Schedule the timer to fire after the given delay, replacing when it was due to fire if it's already scheduled.
+ *
+ *  @param timer A timer created by the receiver.
+ *  @param delay How long from now to fire, 0 or less for as soon as possible.
+ */
+- (void)scheduleTimer:(TOWheelTimer *)timer after:(NSTimeInterval)delay;
+
+/**
+ *  Cancel the timer if it's scheduled, otherwise do nothing. A timer whose block is already running isn't affected.
+ *
+ *  @param timer A timer created by the receiver.
+ */
+- (void)cancelTimer:(TOWheelTimer *)timer;
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
+#undef TO_nullable
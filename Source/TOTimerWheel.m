@@ -0,0 +1,418 @@
+//
+//  TOTimerWheel.m
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOTimerWheel.h"
+#import "TOTime.h"
+#import <pthread.h>
+#import <stdatomic.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#else
+#define nullable
+#endif
+
+#define TO_WHEEL_SLOT_BITS 6
+#define TO_WHEEL_SLOTS (1 << TO_WHEEL_SLOT_BITS)
+#define TO_WHEEL_SLOT_MASK (TO_WHEEL_SLOTS - 1)
+#define TO_WHEEL_LEVELS 6 // spans 2^36 ticks, timers due later than that cascade through the top level again
+
+static inline uint64_t TORotateRight(uint64_t bits, unsigned int shift)
+{
+    return shift == 0 ? bits : (bits >> shift) | (bits << (64 - shift));
+}
+
+
+@interface TOWheelTimer () {
+  @package
+    dispatch_block_t _block;
+    // the rest are guarded by the wheel's mutex
+    __unsafe_unretained TOWheelTimer *_prev; // neighbours in its slot while scheduled
+    __unsafe_unretained TOWheelTimer *_next;
+    uint64_t _expires;     // the tick it's due
+    uint64_t _firingEpoch; // _epoch when taken from the wheel to fire
+    uint8_t _level;
+    uint8_t _slot;
+    _Atomic(NSUInteger) _epoch;  // incremented whenever scheduled or cancelled, so a stale firing is skipped
+    _Atomic(bool) _scheduled;
+}
+- (instancetype)initWithBlock:(dispatch_block_t)block;
+@end
+
+@implementation TOWheelTimer
+
+- (instancetype)initWithBlock:(dispatch_block_t)block
+{
+    if (!(self = [super init]))
+        return nil;
+    _block = [block copy];
+    return self;
+}
+
+- (BOOL)scheduled
+{
+    return atomic_load(&_scheduled);
+}
+
+@end
+
+
+// the wheel's state and thread, separate from TOTimerWheel so that the thread can keep it alive until shut down
+@interface TOTimerWheelCore : NSObject
+- (instancetype)initWithResolution:(uint64_t)resolution;
+- (void)scheduleTimer:(TOWheelTimer *)timer after:(uint64_t)delay;
+- (void)cancelTimer:(TOWheelTimer *)timer;
+- (void)shutDown;
+- (void)run;
+@end
+
+static void *TOTimerWheelMain(void *argument)
+{
+    TOTimerWheelCore *core = (__bridge_transfer TOTimerWheelCore *)argument;
+    pthread_setname_np("TotalObserver timer wheel");
+    [core run];
+    return NULL;
+}
+
+@implementation TOTimerWheelCore {
+    pthread_mutex_t _mutex;
+    pthread_cond_t _condition;
+    uint64_t _resolution; // in nanoseconds
+    uint64_t _origin;     // time of tick 0, in nanoseconds
+    uint64_t _nextTick;   // the next tick to process, all before it have been
+    uint64_t _wakeTick;   // when the sleeping thread wakes, UINT64_MAX if not until signalled, 0 while it's awake
+    NSUInteger _count;
+    __unsafe_unretained TOWheelTimer *_slots[TO_WHEEL_LEVELS][TO_WHEEL_SLOTS]; // each scheduled timer is retained
+    uint64_t _occupied[TO_WHEEL_LEVELS]; // a bit for each slot with timers
+    NSMutableArray *_dueTimers; // only used by the thread
+    BOOL _threadStarted;
+    BOOL _shuttingDown;
+}
+
+- (instancetype)initWithResolution:(uint64_t)resolution
+{
+    if (!(self = [super init]))
+        return nil;
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_condition, NULL);
+    _resolution = resolution;
+    _origin = TONanosecondsNow();
+    _dueTimers = [NSMutableArray array];
+    return self;
+}
+
+- (void)dealloc
+{
+    for (int level = 0; level < TO_WHEEL_LEVELS; ++level) {
+        for (int slot = 0; slot < TO_WHEEL_SLOTS; ++slot) {
+            TOWheelTimer *timer = _slots[level][slot];
+            while (timer != nil) {
+                TOWheelTimer *next = timer->_next;
+                atomic_store(&timer->_scheduled, false);
+                CFRelease((__bridge CFTypeRef)timer);
+                timer = next;
+            }
+        }
+    }
+    pthread_mutex_destroy(&_mutex);
+    pthread_cond_destroy(&_condition);
+}
+
+// all of the following up to -scheduleTimer:after: are called with _mutex held
+
+- (void)addTimer:(TOWheelTimer *)timer
+{
+    // as with the classic kernel timer wheel, the level is chosen by how far away the timer is due, and the slot by the
+    // bits of its due tick for that level, so it cascades to lower levels as its tick approaches
+    uint64_t tick = timer->_expires > _nextTick ? timer->_expires : _nextTick; // overdue ones fire with the next tick
+    uint64_t delta = tick - _nextTick;
+    int level = 0;
+    while (level < TO_WHEEL_LEVELS - 1 && delta >= (1ull << (TO_WHEEL_SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    if (delta >= (1ull << (TO_WHEEL_SLOT_BITS * TO_WHEEL_LEVELS)))
+        tick = _nextTick + (1ull << (TO_WHEEL_SLOT_BITS * TO_WHEEL_LEVELS)) - 1; // as far as it reaches, see processTick
+    uint8_t slot = (tick >> (TO_WHEEL_SLOT_BITS * level)) & TO_WHEEL_SLOT_MASK;
+
+    timer->_level = (uint8_t)level;
+    timer->_slot = slot;
+    timer->_prev = nil;
+    timer->_next = _slots[level][slot];
+    if (timer->_next != nil)
+        timer->_next->_prev = timer;
+    _slots[level][slot] = timer;
+    _occupied[level] |= 1ull << slot;
+}
+
+- (void)unlinkTimer:(TOWheelTimer *)timer
+{
+    if (timer->_prev != nil)
+        timer->_prev->_next = timer->_next;
+    else
+        _slots[timer->_level][timer->_slot] = timer->_next;
+    if (timer->_next != nil)
+        timer->_next->_prev = timer->_prev;
+    if (_slots[timer->_level][timer->_slot] == nil)
+        _occupied[timer->_level] &= ~(1ull << timer->_slot);
+    timer->_prev = nil;
+    timer->_next = nil;
+}
+
+- (TOWheelTimer *)detachSlot:(uint8_t)slot level:(int)level
+{
+    TOWheelTimer *timers = _slots[level][slot];
+    _slots[level][slot] = nil;
+    _occupied[level] &= ~(1ull << slot);
+    return timers;
+}
+
+// the earliest tick with either timers due or timers to cascade to a lower level, UINT64_MAX if there are no timers
+- (uint64_t)nextDueTick
+{
+    uint64_t due = UINT64_MAX;
+    if (_occupied[0] != 0) {
+        // all level 0 timers are due within the next rotation
+        uint64_t bits = TORotateRight(_occupied[0], _nextTick & TO_WHEEL_SLOT_MASK);
+        due = _nextTick + __builtin_ctzll(bits);
+    }
+    for (int level = 1; level < TO_WHEEL_LEVELS; ++level) {
+        if (_occupied[level] == 0)
+            continue;
+        // slots at this level cascade when the tick is a multiple of the level's span, in turn
+        unsigned int shift = TO_WHEEL_SLOT_BITS * level;
+        uint64_t base = _nextTick >> shift;
+        uint64_t bits = TORotateRight(_occupied[level], base & TO_WHEEL_SLOT_MASK);
+        uint64_t offset;
+        if ((_nextTick & ((1ull << shift) - 1)) == 0)
+            offset = __builtin_ctzll(bits); // the current slot is yet to cascade
+        else
+            offset = (bits >> 1) != 0 ? __builtin_ctzll(bits >> 1) + 1 : TO_WHEEL_SLOTS;
+        uint64_t cascade = (base + offset) << shift;
+        if (cascade < due)
+            due = cascade;
+    }
+    return due;
+}
+
+- (void)processTick
+{
+    uint64_t tick = _nextTick;
+    uint8_t slot = tick & TO_WHEEL_SLOT_MASK;
+    if (slot == 0) {
+        for (int level = 1; level < TO_WHEEL_LEVELS; ++level) {
+            uint8_t index = (tick >> (TO_WHEEL_SLOT_BITS * level)) & TO_WHEEL_SLOT_MASK;
+            TOWheelTimer *timer = [self detachSlot:index level:level];
+            while (timer != nil) {
+                TOWheelTimer *next = timer->_next;
+                [self addTimer:timer];
+                timer = next;
+            }
+            if (index != 0)
+                break;
+        }
+    }
+
+    TOWheelTimer *timer = [self detachSlot:slot level:0];
+    while (timer != nil) {
+        TOWheelTimer *next = timer->_next;
+        if (timer->_expires > tick) {
+            // due beyond the wheel's span when added, so placed at its far end, and goes round again from here
+            [self addTimer:timer];
+            timer = next;
+            continue;
+        }
+        timer->_prev = nil;
+        timer->_next = nil;
+        timer->_firingEpoch = atomic_load(&timer->_epoch);
+        atomic_store(&timer->_scheduled, false);
+        [_dueTimers addObject:timer];
+        CFRelease((__bridge CFTypeRef)timer); // the wheel's reference, now held by the array
+        --_count;
+        timer = next;
+    }
+    _nextTick = tick + 1;
+}
+
+- (void)processTicksThrough:(uint64_t)now
+{
+    while (_nextTick <= now) {
+        // skip straight to the next tick with anything to do, ones between have empty slots
+        uint64_t due = [self nextDueTick];
+        if (due > now) {
+            _nextTick = now + 1;
+            break;
+        }
+        _nextTick = due;
+        [self processTick];
+    }
+}
+
+- (void)startThreadIfNeeded
+{
+    if (_threadStarted)
+        return;
+    _threadStarted = YES;
+    pthread_t thread;
+    void *argument = (__bridge_retained void *)self;
+    if (pthread_create(&thread, NULL, TOTimerWheelMain, argument) != 0) {
+        CFRelease(argument);
+        [NSException raise:NSInternalInconsistencyException format:@"Could not create thread for %@", self];
+    }
+    pthread_detach(thread);
+}
+
+- (void)scheduleTimer:(TOWheelTimer *)timer after:(uint64_t)delay
+{
+    uint64_t now = TONanosecondsNow();
+
+    pthread_mutex_lock(&_mutex);
+
+    [self startThreadIfNeeded];
+    atomic_fetch_add(&timer->_epoch, 1);
+    if (atomic_load(&timer->_scheduled)) {
+        [self unlinkTimer:timer];
+    }
+    else {
+        CFRetain((__bridge CFTypeRef)timer);
+        atomic_store(&timer->_scheduled, true);
+        ++_count;
+    }
+    // rounded up, never firing early
+    timer->_expires = (now - _origin + delay + _resolution - 1) / _resolution;
+    [self addTimer:timer];
+    if (timer->_expires < _wakeTick)
+        pthread_cond_signal(&_condition);
+
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (void)cancelTimer:(TOWheelTimer *)timer
+{
+    BOOL wasScheduled = NO;
+
+    pthread_mutex_lock(&_mutex);
+
+    atomic_fetch_add(&timer->_epoch, 1);
+    if (atomic_load(&timer->_scheduled)) {
+        [self unlinkTimer:timer];
+        atomic_store(&timer->_scheduled, false);
+        --_count;
+        wasScheduled = YES;
+    }
+
+    pthread_mutex_unlock(&_mutex);
+
+    if (wasScheduled)
+        CFRelease((__bridge CFTypeRef)timer); // after unlocking, in case it's the last reference
+}
+
+- (void)shutDown
+{
+    pthread_mutex_lock(&_mutex);
+    _shuttingDown = YES;
+    pthread_cond_signal(&_condition);
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (void)run
+{
+    pthread_mutex_lock(&_mutex);
+    while (!_shuttingDown) {
+        _wakeTick = 0;
+        uint64_t now = TONanosecondsNow();
+        [self processTicksThrough:(now - _origin) / _resolution];
+
+        if (_dueTimers.count > 0) {
+            pthread_mutex_unlock(&_mutex);
+            @autoreleasepool {
+                for (TOWheelTimer *timer in _dueTimers) {
+                    if (atomic_load(&timer->_epoch) == timer->_firingEpoch) // not rescheduled or cancelled since
+                        timer->_block();
+                }
+                [_dueTimers removeAllObjects];
+            }
+            pthread_mutex_lock(&_mutex);
+            continue;
+        }
+
+        _wakeTick = [self nextDueTick];
+        if (_wakeTick == UINT64_MAX) {
+            pthread_cond_wait(&_condition, &_mutex);
+        }
+        else {
+            uint64_t wakeTime = _origin + _wakeTick * _resolution;
+            if (wakeTime > now) {
+                uint64_t wait = wakeTime - now;
+                struct timespec timeout = { (time_t)(wait / NSEC_PER_SEC), (long)(wait % NSEC_PER_SEC) };
+                pthread_cond_timedwait_relative_np(&_condition, &_mutex, &timeout);
+            }
+        }
+    }
+    pthread_mutex_unlock(&_mutex);
+}
+
+@end
+
+
+@implementation TOTimerWheel {
+    TOTimerWheelCore *_core;
+}
+
++ (instancetype)sharedWheel
+{
+    static TOTimerWheel *sharedWheel = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedWheel = [[self alloc] initWithResolution:0.001];
+    });
+    return sharedWheel;
+}
+
+- (instancetype)initWithResolution:(NSTimeInterval)resolution
+{
+    NSParameterAssert(resolution > 0);
+    if (!(self = [super init]))
+        return nil;
+    _resolution = resolution;
+    uint64_t nanoseconds = (uint64_t)(resolution * NSEC_PER_SEC);
+    _core = [[TOTimerWheelCore alloc] initWithResolution:nanoseconds > 0 ? nanoseconds : 1];
+    return self;
+}
+
+- (void)dealloc
+{
+    [_core shutDown];
+}
+
+- (TOWheelTimer *)timerWithBlock:(dispatch_block_t)block
+{
+    return [[TOWheelTimer alloc] initWithBlock:block];
+}
+
+- (void)scheduleTimer:(TOWheelTimer *)timer after:(NSTimeInterval)delay
+{
+    [_core scheduleTimer:timer after:delay > 0 ? (uint64_t)(delay * NSEC_PER_SEC) : 0];
+}
+
+- (void)cancelTimer:(TOWheelTimer *)timer
+{
+    [_core cancelTimer:timer];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ %p: resolution=%g>", NSStringFromClass([self class]), self, self.resolution];
+}
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#else
+#undef nullable
+#endif
@@ -0,0 +1,46 @@
+//
+//  TOWatchdog.h
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+//  Tracks when an observation was last triggered, and calls a handler once it's been silent for longer than a
+//  threshold. Noting a trigger only stores the time, the timer on the shared `TOTimerWheel` isn't moved along with
+//  it. Instead when the timer fires early it's scheduled again for the remainder of the threshold.
+
+#import <Foundation/Foundation.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#define TO_nullable nullable
+#else
+#define TO_nullable
+#endif
+
+@interface TOWatchdog : NSObject
+
+/**
+ *  Initializes and returns a watchdog, counting silence from now.
+ *
+ *  @param threshold How long without a trigger is considered silent, greater than 0.
+ *  @param handler   Called on a global queue with how long it's been silent, once for each silent period.
+ */
+- (instancetype)initWithThreshold:(NSTimeInterval)threshold handler:(void(^)(NSTimeInterval silence))handler;
+
+/**
+ *  Restart the silence, scheduling the timer again if it last fired for a silent period. Lock-free unless so.
+ */
+- (void)noteTrigger;
+
+/**
+ *  Stop watching, the handler won't be called after this returns unless it's already on its way.
+ */
+- (void)stop;
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#endif
+#undef TO_nullable
@@ -0,0 +1,101 @@
+//
+//  TOWatchdog.m
+//  TotalObserver
+//
+//  Created by Pierre Houston on 2026-10-17.
+//  Copyright © 2026 Pierre Houston. All rights reserved.
+//
+
+#import "TOWatchdog.h"
+#import "TOTimerWheel.h"
+#import "TOTime.h"
+#import <stdatomic.h>
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_BEGIN
+#else
+#define nullable
+#endif
+
+
+@implementation TOWatchdog {
+    uint64_t _threshold; // in nanoseconds
+    void (^_handler)(NSTimeInterval silence);
+    TOWheelTimer *_timer;
+    _Atomic(uint64_t) _lastTriggerTime;
+    _Atomic(bool) _armed; // timer is scheduled, or about to be
+    _Atomic(bool) _stopped;
+}
+
+- (instancetype)initWithThreshold:(NSTimeInterval)threshold handler:(void(^)(NSTimeInterval silence))handler
+{
+    NSParameterAssert(threshold > 0);
+    if (!(self = [super init]))
+        return nil;
+    _threshold = (uint64_t)(threshold * NSEC_PER_SEC);
+    _handler = [handler copy];
+    atomic_store(&_lastTriggerTime, TONanosecondsNow());
+    
+    typeof(self) __weak welf = self;
+    _timer = [[TOTimerWheel sharedWheel] timerWithBlock:^{
+        [welf check];
+    }];
+    atomic_store(&_armed, true);
+    [self scheduleAfter:_threshold];
+    return self;
+}
+
+- (void)dealloc
+{
+    [[TOTimerWheel sharedWheel] cancelTimer:_timer];
+}
+
+- (void)scheduleAfter:(uint64_t)delay
+{
+    [[TOTimerWheel sharedWheel] scheduleTimer:_timer after:(NSTimeInterval)delay / NSEC_PER_SEC];
+}
+
+- (void)noteTrigger
+{
+    atomic_store_explicit(&_lastTriggerTime, TONanosecondsNow(), memory_order_relaxed);
+    if (!atomic_load_explicit(&_armed, memory_order_relaxed) && !atomic_exchange(&_armed, true) && !atomic_load(&_stopped))
+        [self scheduleAfter:_threshold];
+}
+
+- (void)stop
+{
+    atomic_store(&_stopped, true);
+    [[TOTimerWheel sharedWheel] cancelTimer:_timer];
+}
+
+// called on the wheel's thread
+- (void)check
+{
+    if (atomic_load(&_stopped))
+        return;
+    
+    // disarmed before looking at the time, so a trigger from here on either is seen below or arms the timer itself
+    atomic_store(&_armed, false);
+    uint64_t now = TONanosecondsNow();
+    uint64_t lastTriggerTime = atomic_load(&_lastTriggerTime);
+    uint64_t silence = now > lastTriggerTime ? now - lastTriggerTime : 0;
+    if (silence < _threshold) {
+        if (!atomic_exchange(&_armed, true))
+            [self scheduleAfter:_threshold - silence];
+        return;
+    }
+    
+    // stays disarmed until the next trigger, which starts a new silent period
+    void (^handler)(NSTimeInterval) = _handler;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+        handler((NSTimeInterval)silence / NSEC_PER_SEC);
+    });
+}
+
+@end
+
+#if __has_feature(nullability)
+NS_ASSUME_NONNULL_END
+#else
+#undef nullable
+#endif
@@ -7,7 +7,10 @@
 //
 
 #import "TOObservation.h"
+#import "TOObservationBag.h"
+#import "TOExecutor.h"
 #import "TOKVOObservation.h"
+#import "TOKVOScalarObservation.h"
 #import "NSObject+TotalObserverKVO.h"
 #import "TONotificationObservation.h"
 #import "NSObject+TotalObserverNotifications.h"
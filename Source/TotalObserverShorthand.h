@@ -17,6 +17,8 @@
 
 #import "TOObservation.h"
 #import "TOObservation+Shorthand.h"
+#import "TOObservationBag.h"
+#import "TOExecutor.h"
 #import "TOKVOObservation.h"
 #import "NSObject+TotalObserverKVO.h"
 #import "NSObject+TotalObserverKVOShorthand.h"
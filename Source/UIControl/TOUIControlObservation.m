@@ -71,9 +71,19 @@ NS_ASSUME_NONNULL_BEGIN
     [(UIControl *)self.object removeTarget:self action:@selector(action:forEvent:) forControlEvents:self.events];
 }
 
++ (NSString *)hashKeyForEvents:(UIControlEvents)events
+{
+    return [NSString stringWithFormat:@"uicontrol|%lx", (unsigned long)events];
+}
+
+- (nullable NSString *)hashKey
+{
+    return [TOUIControlObservation hashKeyForEvents:self.events];
+}
+
 + (BOOL)removeForObserver:(nullable id)observer control:(UIControl *)control events:(UIControlEvents)events
 {
-    TOObservation *observation = [self findObservationForObserver:observer object:control matchingTest:^BOOL(TOObservation *observation) {
+    TOObservation *observation = [self findObservationForObserver:observer object:control hashKey:[TOUIControlObservation hashKeyForEvents:events] matchingTest:^BOOL(TOObservation *observation) {
         return [observation isKindOfClass:[TOUIControlObservation class]] && ((TOUIControlObservation *)observation).events == events;
     }];
     if (observation != nil) {
@@ -15,6 +15,8 @@ FOUNDATION_EXPORT double TotalObserverVersionNumber;
 FOUNDATION_EXPORT const unsigned char TotalObserverVersionString[];
 
 #import "TOObservation.h"
+#import "TOObservationBag.h"
+#import "TOExecutor.h"
 #import "TOKVOObservation.h"
 #import "NSObject+TotalObserverKVO.h"
 #import "TONotificationObservation.h"